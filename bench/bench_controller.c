@@ -0,0 +1,60 @@
+#include <string.h>
+#include "controller.h"
+#include "intersection.h"
+#include "road.h"
+#include "bench_helpers.h"
+
+/*
+ * Controller benchmarks on a realistically loaded intersection:
+ * traffic on every road, a mix of all three movements.
+ */
+
+static Intersection inter;
+
+static void load_intersection(void) {
+    intersection_init(&inter);
+    static const RoadDir left[ROAD_COUNT] = {
+        [ROAD_NORTH] = ROAD_EAST,  [ROAD_SOUTH] = ROAD_WEST,
+        [ROAD_EAST]  = ROAD_SOUTH, [ROAD_WEST]  = ROAD_NORTH,
+    };
+    static const RoadDir straight[ROAD_COUNT] = {
+        [ROAD_NORTH] = ROAD_SOUTH, [ROAD_SOUTH] = ROAD_NORTH,
+        [ROAD_EAST]  = ROAD_WEST,  [ROAD_WEST]  = ROAD_EAST,
+    };
+    for (int r = 0; r < ROAD_COUNT; r++) {
+        for (int i = 0; i < 8; i++) {
+            intersection_add_vehicle(&inter, (RoadDir)r, straight[r], "s");
+            intersection_add_vehicle(&inter, (RoadDir)r, left[r], "l");
+        }
+    }
+}
+
+static void bench_phase_score_scratch(uint64_t iters) {
+    /* The from-scratch reference scan (what every decision used to cost). */
+    for (uint64_t i = 0; i < iters; i++) {
+        bench_sink += controller_phase_score(&inter, (Phase)(i & 3));
+    }
+}
+
+static void bench_next_phase(uint64_t iters) {
+    /* The cached 4-way max actually used on the step path. */
+    for (uint64_t i = 0; i < iters; i++) {
+        PhaseDecision d = controller_next_phase(&inter);
+        bench_sink += d.phase + d.duration;
+    }
+}
+
+static void bench_rebuild_scores(uint64_t iters) {
+    for (uint64_t i = 0; i < iters; i++) {
+        intersection_rebuild_scores(&inter);
+        bench_sink += inter.phase_scores[PHASE_NS];
+    }
+}
+
+int main(void) {
+    load_intersection();
+    bench_run("controller_phase_score (scratch)", bench_phase_score_scratch, 10000000);
+    bench_run("controller_next_phase (cached)",   bench_next_phase,          10000000);
+    bench_run("intersection_rebuild_scores",      bench_rebuild_scores,       2000000);
+    return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef BENCH_HELPERS_H
+#define BENCH_HELPERS_H
+
+/*
+ * bench_helpers.h - minimal self-contained timing harness
+ *
+ * Mirrors test_helpers.h in spirit: no dependencies, one macro-ish API.
+ * Each benchmark is a function that runs 'iters' operations; bench_run()
+ * times it around a warmup pass and prints ns/op and ops/sec.
+ *
+ * Numbers are for relative comparison between commits, not absolute
+ * truth - pin the CPU governor before trusting small deltas.
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Assign results here so the compiler can't delete the measured work. */
+static volatile uint64_t bench_sink;
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+typedef void (*bench_fn)(uint64_t iters);
+
+static void bench_run(const char *name, bench_fn fn, uint64_t iters) {
+    fn(iters / 10 + 1); /* warmup: touch caches, settle branch predictors */
+
+    uint64_t t0      = bench_now_ns();
+    fn(iters);
+    uint64_t elapsed = bench_now_ns() - t0;
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+
+    printf("%-36s %10" PRIu64 " ops  %8.2f ns/op  %14.0f ops/sec\n",
+           name, iters,
+           (double)elapsed / (double)iters,
+           (double)iters * 1e9 / (double)elapsed);
+    fflush(stdout);
+}
+
+#endif /* BENCH_HELPERS_H */
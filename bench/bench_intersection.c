@@ -0,0 +1,58 @@
+#include <string.h>
+#include "intersection.h"
+#include "road.h"
+#include "bench_helpers.h"
+
+/*
+ * End-to-end step benchmarks: steps/sec is the headline number for
+ * batch replays and the grid-scale work.
+ */
+
+static Intersection inter;
+
+static void bench_step_empty(uint64_t iters) {
+    /* No traffic: controller + light ticking + bookkeeping only. */
+    intersection_init(&inter);
+    for (uint64_t i = 0; i < iters; i++) {
+        Vehicle departed[MAX_DEPARTURES_PER_STEP];
+        uint8_t count;
+        intersection_step(&inter, departed, &count);
+        bench_sink += count;
+    }
+}
+
+static void bench_step_loaded(uint64_t iters) {
+    /* Sustained load: two arrivals per step on alternating axes, so
+     * queues stay populated and every step departs vehicles. */
+    intersection_init(&inter);
+    for (uint64_t i = 0; i < iters; i++) {
+        if (i & 1) {
+            intersection_add_vehicle(&inter, ROAD_NORTH, ROAD_SOUTH, "n");
+            intersection_add_vehicle(&inter, ROAD_SOUTH, ROAD_EAST,  "s");
+        } else {
+            intersection_add_vehicle(&inter, ROAD_EAST, ROAD_WEST,   "e");
+            intersection_add_vehicle(&inter, ROAD_WEST, ROAD_NORTH,  "w");
+        }
+        Vehicle departed[MAX_DEPARTURES_PER_STEP];
+        uint8_t count;
+        intersection_step(&inter, departed, &count);
+        bench_sink += count;
+    }
+}
+
+static void bench_add_vehicle(uint64_t iters) {
+    intersection_init(&inter);
+    for (uint64_t i = 0; i < iters; i++) {
+        intersection_add_vehicle(&inter, ROAD_NORTH, ROAD_SOUTH, "v");
+        Vehicle out;
+        road_dequeue_lane(&inter.roads[ROAD_NORTH], LANE_STRAIGHT, &out);
+        bench_sink += out.id;
+    }
+}
+
+int main(void) {
+    bench_run("intersection_step (empty)",  bench_step_empty,  5000000);
+    bench_run("intersection_step (loaded)", bench_step_loaded, 5000000);
+    bench_run("intersection_add_vehicle",   bench_add_vehicle, 5000000);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <string.h>
+#include "road.h"
+#include "bench_helpers.h"
+
+/*
+ * Queue-level benchmarks: the enqueue/dequeue pair is the innermost
+ * per-vehicle cost of the whole engine.
+ */
+
+static Vehicle make_vehicle(void) {
+    Vehicle v;
+    memset(&v, 0, sizeof(v));
+    v.id       = 1;
+    v.end_road = ROAD_SOUTH;
+    v.movement = MOVE_STRAIGHT;
+    return v;
+}
+
+static void bench_enqueue_dequeue(uint64_t iters) {
+    VehicleQueue q;
+    queue_init(&q);
+    Vehicle v = make_vehicle();
+
+    for (uint64_t i = 0; i < iters; i++) {
+        queue_enqueue(&q, &v);
+        Vehicle out;
+        queue_dequeue(&q, &out);
+        bench_sink += out.id;
+    }
+}
+
+static void bench_enqueue_dequeue_full(uint64_t iters) {
+    /* Same pair, but through a nearly full ring (worst-case wrap). */
+    VehicleQueue q;
+    queue_init(&q);
+    Vehicle v = make_vehicle();
+    for (int i = 0; i < MAX_VEHICLES_PER_LANE - 1; i++) {
+        queue_enqueue(&q, &v);
+    }
+
+    for (uint64_t i = 0; i < iters; i++) {
+        queue_enqueue(&q, &v);
+        Vehicle out;
+        queue_dequeue(&q, &out);
+        bench_sink += out.id;
+    }
+}
+
+static void bench_peek(uint64_t iters) {
+    VehicleQueue q;
+    queue_init(&q);
+    Vehicle v = make_vehicle();
+    queue_enqueue(&q, &v);
+
+    for (uint64_t i = 0; i < iters; i++) {
+        Vehicle out;
+        queue_peek(&q, &out);
+        bench_sink += out.enqueue_step;
+    }
+}
+
+static void bench_road_total_count(uint64_t iters) {
+    Road r;
+    road_init(&r);
+    Vehicle v = make_vehicle();
+    for (int i = 0; i < 10; i++) {
+        road_enqueue(&r, &v);
+    }
+
+    for (uint64_t i = 0; i < iters; i++) {
+        bench_sink += road_total_count(&r);
+    }
+}
+
+int main(void) {
+    bench_run("queue_enqueue+dequeue",      bench_enqueue_dequeue,      10000000);
+    bench_run("queue_enqueue+dequeue/full", bench_enqueue_dequeue_full, 10000000);
+    bench_run("queue_peek",                 bench_peek,                 10000000);
+    bench_run("road_total_count",           bench_road_total_count,     10000000);
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "controller.h"
+#include "generate.h"
+#include "intern.h"
+#include "intersection.h"
+#include "road.h"
+
+/*
+ * soak - long-horizon engine soak under sustained generated load
+ *
+ *   soak [seconds] [rate] [seed]
+ *
+ * Drives intersection_step() with Poisson arrivals (mean 'rate' per
+ * road per step, default 1.0) for a wall-time budget (default 10 s),
+ * continuously checking queue invariants, and reports throughput and
+ * peak RSS as key=value lines on stdout - one metric per line, stable
+ * order, so two releases diff with plain diff(1).
+ *
+ * Not registered with ctest: it runs for wall time by design and its
+ * numbers are for humans and release gates, not pass/fail. A failed
+ * invariant does exit non-zero, so CI can still run it as a tripwire.
+ *
+ * Vehicle ids cycle through a small pre-interned pool - a soak is
+ * about engine throughput, and billions of unique ids would turn it
+ * into an intern-table benchmark (and an OOM).
+ */
+
+#define SOAK_ID_POOL 256
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static Intersection inter;
+
+#define FAIL(...)                                                           \
+    do {                                                                    \
+        fprintf(stderr, "soak: FAIL at step %u: ", inter.step_count);       \
+        fprintf(stderr, __VA_ARGS__);                                       \
+        fputc('\n', stderr);                                                \
+        exit(1);                                                            \
+    } while (0)
+
+/* Full cross-check of the cached scores against a recomputation from
+ * the queues; too heavy for every step, run on a stride. */
+static void check_scores(void) {
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        uint32_t reference = controller_phase_score(&inter, (Phase)p);
+        if (inter.phase_scores[p] != reference) {
+            FAIL("cached score for phase %d is %u, recomputed %u",
+                 p, inter.phase_scores[p], reference);
+        }
+    }
+    for (int r = 0; r < ROAD_COUNT; r++) {
+        for (int l = 0; l < LANES_PER_ROAD; l++) {
+            uint8_t count = road_lane_count(&inter.roads[r], (Lane)l);
+            uint8_t limit = MAX_VEHICLES_PER_LANE;
+#if TSIM_SPILL_POOL
+            limit = MAX_VEHICLES_PER_LANE + SPILL_POOL_SIZE;
+#endif
+            if (count > limit) {
+                FAIL("lane %d/%d holds %u vehicles (limit %u)",
+                     r, l, count, limit);
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 10.0;
+    double rate    = argc > 2 ? atof(argv[2]) : 1.0;
+    uint64_t seed  = argc > 3 ? strtoull(argv[3], NULL, 10) : 1;
+    if (seconds <= 0.0 || rate < 0.0) {
+        fprintf(stderr, "usage: %s [seconds] [rate] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    intersection_init(&inter);
+
+    /* Pre-intern the cycling id pool so the hot loop never snprintfs. */
+    uint32_t ids[SOAK_ID_POOL];
+    for (int i = 0; i < SOAK_ID_POOL; i++) {
+        char id[MAX_VEHICLE_ID_LEN];
+        snprintf(id, sizeof(id), "s%d", i);
+        ids[i] = vehicle_id_intern(id);
+    }
+
+    GenRng   rng       = { seed != 0 ? seed : 1 };
+    uint64_t generated = 0;   /* arrivals offered to the engine */
+    uint64_t accepted  = 0;   /* arrivals the engine took */
+    uint64_t departed  = 0;
+    uint64_t steps     = 0;
+    uint64_t checks    = 0;
+
+    uint64_t t0        = now_ns();
+    uint64_t budget_ns = (uint64_t)(seconds * 1e9);
+    uint64_t elapsed   = 0;
+
+    for (;;) {
+        for (int r = 0; r < ROAD_COUNT; r++) {
+            uint32_t arrivals = gen_poisson(&rng, rate);
+            for (uint32_t i = 0; i < arrivals; i++) {
+                /* +1..+3 skips the U-turn; all three movements occur. */
+                RoadDir end = (RoadDir)((r + 1 +
+                                         gen_rng_next(&rng) % 3) % 4);
+                if (intersection_add_vehicle_interned(
+                        &inter, (RoadDir)r, end,
+                        ids[generated % SOAK_ID_POOL])) {
+                    accepted++;
+                }
+                generated++;
+            }
+        }
+
+        Vehicle out[MAX_DEPARTURES_PER_STEP];
+        uint8_t count;
+        intersection_step(&inter, out, &count);
+        steps++;
+
+        /* Cheap per-step invariants. */
+        if (count > MAX_DEPARTURES_PER_STEP) {
+            FAIL("%u departures in one step (limit %d)",
+                 count, MAX_DEPARTURES_PER_STEP);
+        }
+        for (uint8_t d = 0; d < count; d++) {
+            if (out[d].enqueue_step >= inter.step_count) {
+                FAIL("departure enqueued at step %u, after now",
+                     out[d].enqueue_step);
+            }
+        }
+        departed += count;
+
+        /* Conservation: everything accepted is still queued or has
+         * departed. Summed by hand - intersection_total_waiting()
+         * returns uint8_t and a soaked intersection holds more. */
+        uint32_t waiting = 0;
+        for (int r = 0; r < ROAD_COUNT; r++) {
+            for (int l = 0; l < LANES_PER_ROAD; l++) {
+                waiting += road_lane_count(&inter.roads[r], (Lane)l);
+            }
+        }
+        if (accepted - departed != waiting) {
+            FAIL("conservation broken: accepted %llu, departed %llu, "
+                 "waiting %u",
+                 (unsigned long long)accepted,
+                 (unsigned long long)departed, waiting);
+        }
+
+        if ((steps & 1023) == 0) {
+            check_scores();
+            checks++;
+        }
+        if ((steps & 4095) == 0) {
+            elapsed = now_ns() - t0;
+            if (elapsed >= budget_ns) {
+                break;
+            }
+        }
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    double secs = (double)elapsed / 1e9;
+    printf("steps=%llu\n", (unsigned long long)steps);
+    printf("vehicles_generated=%llu\n", (unsigned long long)generated);
+    printf("vehicles_accepted=%llu\n", (unsigned long long)accepted);
+    printf("vehicles_departed=%llu\n", (unsigned long long)departed);
+    printf("steps_per_sec=%.0f\n", (double)steps / secs);
+    printf("vehicles_per_sec=%.0f\n", (double)departed / secs);
+    printf("invariant_checks=%llu\n", (unsigned long long)checks);
+    printf("elapsed_sec=%.3f\n", secs);
+    printf("peak_rss_kb=%ld\n", usage.ru_maxrss);
+    return 0;
+}
@@ -30,15 +30,27 @@ def run(input_path, output_path):
 
     lines = []
     step_count = 0
+    pending_steps = 0
+
+    def flush_steps():
+        nonlocal pending_steps
+        if pending_steps:
+            # "step N" emits one output line per step, exactly like N
+            # single "step" lines, but costs one pipe round-trip.
+            lines.append(f"step {pending_steps}\n")
+            pending_steps = 0
+
     for cmd in commands:
         t = cmd["type"]
         if t == "addVehicle":
+            flush_steps()
             lines.append(
                 f"addVehicle {cmd['vehicleId']} {cmd['startRoad']} {cmd['endRoad']}\n"
             )
         elif t == "step":
-            lines.append("step\n")
+            pending_steps += 1
             step_count += 1
+    flush_steps()
 
     proc = subprocess.run(
         [find_binary()],
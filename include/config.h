@@ -40,6 +40,31 @@
 /* Number of steps a light stays yellow before turning red. */
 #define YELLOW_STEPS            1
 
+/*
+ * Grid engine (desktop builds)
+ *
+ * Upper bound on stepping threads for a Grid; the actual count is
+ * chosen at grid_create() time and clamped to the cell count.
+ */
+#define GRID_MAX_WORKERS        16
+
+/* Capacity of one inter-intersection handoff ring (power of two; one
+   slot is reserved to tell full from empty). */
+#define HANDOFF_RING_SIZE       64
+
+/* Capacity of the ISR-to-tick sensor event queue (power of two). Sized
+ * for a full burst of edges on all 12 lanes between two ticks. */
+#define SENSOR_QUEUE_SIZE       32
+
+/* Nodes in the shared overflow spill pool (desktop builds with
+ * TSIM_SPILL_POOL only; see types.h). Indices are stored as uint8_t
+ * plus one, so this must stay <= 254. */
+#define SPILL_POOL_SIZE         128
+
+/* Journal records between fsyncs (see journal.h). Bounds the commands a
+ * crash can lose against paying a disk flush on every append. */
+#define JOURNAL_SYNC_INTERVAL   64
+
 /* Maximum vehicles that can depart in a single step.
    Main phase: MAX_ROADS_PER_PHASE roads x 2 active lanes (straight + right). */
 #define MAX_DEPARTURES_PER_STEP (MAX_ROADS_PER_PHASE * 2)
@@ -62,10 +62,20 @@ typedef struct {
 
 /*
  * Select the next phase and calculate its duration.
- * Reads intersection state, returns a decision.
+ *
+ * Reads the phase scores cached in the intersection (a 4-way max, no
+ * lane walks); the caches are kept up to date by the intersection's own
+ * enqueue/dequeue/step paths. Callers that modify intersection state
+ * directly must call intersection_rebuild_scores() first.
  */
 PhaseDecision controller_next_phase(const Intersection *inter);
 
+/*
+ * The phase whose score a given (road, lane) contributes to:
+ * the axis arrow phase for LANE_LEFT, the axis main phase otherwise.
+ */
+Phase controller_phase_for_lane(RoadDir road, Lane lane);
+
 /*
  * Calculate the priority score for a single phase.
  * Exposed for unit testing and for README documentation of the algorithm.
@@ -0,0 +1,68 @@
+#ifndef COUNTVEC_H
+#define COUNTVEC_H
+
+/*
+ * countvec.h - packed lane-count vector kernels
+ *
+ * Intersection keeps the 12 lane counts in one contiguous 16-byte
+ * vector (lane_counts in types.h, indexed road * LANES_PER_ROAD + lane,
+ * 4 trailing pad bytes always zero). These helpers reduce that vector
+ * with one load + mask + horizontal-add instead of twelve scattered
+ * byte fetches through road_lane_count(); at grid scale the controller
+ * runs them once per intersection per decision.
+ *
+ * SSE2 and NEON paths are selected at compile time with a scalar
+ * fallback; all three produce identical results.
+ */
+
+#include <stdint.h>
+#include "config.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* Sum of counts[i] for every i where mask[i] is 0xFF. */
+static inline uint32_t countvec_sum_masked(const uint8_t counts[16],
+                                           const uint8_t mask[16]) {
+#if defined(__SSE2__)
+    __m128i c = _mm_loadu_si128((const __m128i *)counts);
+    __m128i m = _mm_loadu_si128((const __m128i *)mask);
+    /* _mm_sad_epu8 against zero horizontally sums 8-byte halves. */
+    __m128i sad = _mm_sad_epu8(_mm_and_si128(c, m), _mm_setzero_si128());
+    return (uint32_t)(_mm_cvtsi128_si32(sad) +
+                      _mm_cvtsi128_si32(_mm_srli_si128(sad, 8)));
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    uint8x16_t c = vld1q_u8(counts);
+    uint8x16_t m = vld1q_u8(mask);
+    return vaddlvq_u8(vandq_u8(c, m));
+#else
+    uint32_t sum = 0;
+    for (int i = 0; i < 16; i++) {
+        sum += counts[i] & mask[i];
+    }
+    return sum;
+#endif
+}
+
+/* Sum of all 16 bytes (the pad bytes are zero by invariant). */
+static inline uint32_t countvec_sum(const uint8_t counts[16]) {
+#if defined(__SSE2__)
+    __m128i c   = _mm_loadu_si128((const __m128i *)counts);
+    __m128i sad = _mm_sad_epu8(c, _mm_setzero_si128());
+    return (uint32_t)(_mm_cvtsi128_si32(sad) +
+                      _mm_cvtsi128_si32(_mm_srli_si128(sad, 8)));
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    return vaddlvq_u8(vld1q_u8(counts));
+#else
+    uint32_t sum = 0;
+    for (int i = 0; i < 16; i++) {
+        sum += counts[i];
+    }
+    return sum;
+#endif
+}
+
+#endif /* COUNTVEC_H */
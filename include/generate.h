@@ -0,0 +1,84 @@
+#ifndef GENERATE_H
+#define GENERATE_H
+
+/*
+ * generate.h - native high-volume traffic generator
+ *
+ * gen_examples.py caps stress tests at what Python can emit; the native
+ * generator produces millions of arrivals per second from a small JSON
+ * profile, either streaming them straight into an in-memory
+ * Intersection or writing the binary trace format for later replay.
+ *
+ * Profile schema (all keys optional except "steps"):
+ *
+ *   {
+ *     "seed": 42,
+ *     "steps": 100000,
+ *     "roads": {
+ *       "north": { "rate": 1.5, "turn_ratio": [0.2, 0.6, 0.2] },
+ *       "south": { "rate": 1.5 },
+ *       ...
+ *     },
+ *     "rush": { "start": 1000, "end": 5000, "multiplier": 3.0 }
+ *   }
+ *
+ * "rate" is the Poisson mean of arrivals per step on that road (roads
+ * left out stay silent); "turn_ratio" is the left/straight/right mix
+ * (default 0.25/0.5/0.25). "rush" scales every rate by a triangle ramp
+ * that rises from 1 at "start" to "multiplier" mid-window and back.
+ * Randomness comes from a seeded xorshift64* PRNG, so runs reproduce.
+ */
+
+#include <math.h>
+#include <stdint.h>
+
+/*
+ * xorshift64* PRNG - three shifts and a multiply per draw, passes
+ * BigCrush, and the whole state is one register. Shared by the
+ * generator and the soak harness (bench/soak.c); header-only so users
+ * only need to link libm (for gen_poisson's exp).
+ */
+typedef struct {
+    uint64_t s;   /* must never be zero */
+} GenRng;
+
+static inline uint64_t gen_rng_next(GenRng *g) {
+    uint64_t s = g->s;
+    s ^= s >> 12;
+    s ^= s << 25;
+    s ^= s >> 27;
+    g->s = s;
+    return s * UINT64_C(2685821657736338717);
+}
+
+/* Uniform double in [0, 1): top 53 bits scaled by 2^-53. */
+static inline double gen_rng_double(GenRng *g) {
+    return (double)(gen_rng_next(g) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Knuth's product method: exact and fast for the per-step means a
+ * single intersection can absorb (well under 30). */
+static inline uint32_t gen_poisson(GenRng *g, double lambda) {
+    if (lambda <= 0.0) {
+        return 0;
+    }
+    double   limit = exp(-lambda);
+    double   p     = 1.0;
+    uint32_t k     = 0;
+    do {
+        k++;
+        p *= gen_rng_double(g);
+    } while (p > limit);
+    return k - 1;
+}
+
+/*
+ * Run the profile. With a trace_path, arrivals and steps are written as
+ * a binary trace (see trace.h); with trace_path NULL they feed an
+ * in-memory Intersection directly and a summary goes to stderr.
+ * Returns 0 on success; on failure prints to stderr and returns
+ * non-zero.
+ */
+int generate_run(const char *profile_path, const char *trace_path);
+
+#endif /* GENERATE_H */
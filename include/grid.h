@@ -0,0 +1,78 @@
+#ifndef GRID_H
+#define GRID_H
+
+/*
+ * grid.h - multi-intersection grid engine
+ *
+ * Owns a dense array of Intersection states (cache-line aligned, row-
+ * major, indexed by grid coordinate) and advances all of them in one
+ * grid_step() call. Cells are partitioned statically across a pool of
+ * persistent worker threads: each worker owns a fixed contiguous range
+ * of cells, so there is no work stealing, no shared queue, and no
+ * false sharing between workers' cells.
+ *
+ * The single-intersection engine is the degenerate 1x1 case (with
+ * workers <= 1 no threads are created at all and grid_step() runs
+ * inline).
+ *
+ * Per-cell departures from the latest step are kept in the grid
+ * (grid_departed / grid_departed_count) so callers - and the
+ * inter-intersection handoff layer - can consume them after the step.
+ */
+
+#include <stdint.h>
+#include "types.h"
+
+typedef struct Grid Grid;
+
+/*
+ * Allocate and initialise a width x height grid.
+ *
+ * 'workers' is the number of stepping threads; 0 or 1 means no threads
+ * (serial stepping), and values above GRID_MAX_WORKERS or the cell
+ * count are clamped. Returns NULL on allocation failure.
+ */
+Grid *grid_create(uint16_t width, uint16_t height, int workers);
+
+/* Stop the workers and free all grid memory. NULL is a no-op. */
+void grid_destroy(Grid *grid);
+
+uint16_t grid_width(const Grid *grid);
+uint16_t grid_height(const Grid *grid);
+
+/* The intersection at (x, y). No bounds checking beyond an assert-style
+ * contract: x < width, y < height. */
+Intersection *grid_at(Grid *grid, uint16_t x, uint16_t y);
+
+/*
+ * Advance every intersection by one step, in parallel across the
+ * worker pool. Departures for each cell are available afterwards via
+ * grid_departed()/grid_departed_count() until the next grid_step().
+ */
+void grid_step(Grid *grid);
+
+const Vehicle *grid_departed(const Grid *grid, uint16_t x, uint16_t y);
+uint8_t grid_departed_count(const Grid *grid, uint16_t x, uint16_t y);
+
+/*
+ * Inter-intersection handoff
+ *
+ * When enabled, a vehicle departing a cell toward road D travels for
+ * 'travel_delay' steps (clamped to >= 1) and then enters the neighbor
+ * in direction D on the opposite road, heading straight on. Departures
+ * that cross the grid boundary - and sensor-injected vehicles with no
+ * destination - leave the system and are counted as exits. Handoff
+ * uses one lock-free SPSC ring per directed edge (see handoff.h), so
+ * parallel workers exchange vehicles without any mutex.
+ *
+ * Returns 0 on success, non-zero on allocation failure.
+ */
+int grid_enable_handoff(Grid *grid, uint32_t travel_delay);
+
+/* Vehicles that left the system across the boundary so far. */
+uint64_t grid_exited_count(const Grid *grid);
+
+/* Vehicles dropped because a handoff ring or ingress lane was full. */
+uint64_t grid_dropped_count(const Grid *grid);
+
+#endif /* GRID_H */
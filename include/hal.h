@@ -38,6 +38,18 @@ typedef struct {
      * (e.g. turn the RED pin on and the GREEN/YELLOW/ARROW pins off).
      */
     void (*set_light)(RoadDir road, LightState state);
+
+    /*
+     * commit_lights - apply all pending set_light() calls at once.
+     *
+     * Optional; may be NULL. When provided, set_light() is free to only
+     * stage its output pattern, and this is called once per tick after
+     * all four roads have been staged. Targets whose GPIO hardware can
+     * update a whole port in one register write (e.g. STM32 BSRR) use
+     * this to make every light change atomic per port instead of
+     * rippling across 16 pin writes.
+     */
+    void (*commit_lights)(void);
 } EmbeddedHAL;
 
 #endif /* HAL_H */
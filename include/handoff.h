@@ -0,0 +1,56 @@
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+/*
+ * handoff.h - single-producer/single-consumer vehicle handoff ring
+ *
+ * Carries departures from one grid cell into a neighbor's ingress
+ * without a mutex. Each directed edge of the grid owns one ring; the
+ * worker that steps the source cell is the only producer and the
+ * worker that steps the destination cell is the only consumer, so
+ * C11 acquire/release atomics on the two indices are all the
+ * synchronisation needed - parallel grid workers exchange vehicles
+ * with zero contention.
+ *
+ * Items carry the step at which the vehicle reaches the neighbor
+ * (departure step + travel delay); the consumer peeks and only pops
+ * items whose arrival step has come, which keeps the ring FIFO and
+ * the simulation deterministic regardless of worker interleaving.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+
+typedef struct {
+    uint32_t id;           /* interned vehicle ID                    */
+    uint8_t  ingress_road; /* RoadDir the vehicle enters the neighbor from */
+    uint8_t  heading;      /* RoadDir it keeps heading toward        */
+    uint32_t arrival_step; /* neighbor step at which it arrives      */
+} HandoffItem;
+
+/*
+ * Ring capacity is HANDOFF_RING_SIZE - 1 (one slot is sacrificed to
+ * distinguish full from empty). Must be a power of two.
+ */
+typedef struct {
+    HandoffItem     buf[HANDOFF_RING_SIZE];
+    _Atomic uint32_t head;  /* consumer index */
+    _Atomic uint32_t tail;  /* producer index */
+} HandoffRing;
+
+void handoff_init(HandoffRing *ring);
+
+/* Producer side. Returns false if the ring is full (item dropped). */
+bool handoff_push(HandoffRing *ring, const HandoffItem *item);
+
+/* Consumer side: read the oldest item without removing it.
+ * Returns false if the ring is empty. */
+bool handoff_peek(const HandoffRing *ring, HandoffItem *out);
+
+/* Consumer side: remove the oldest item. Only call after a successful
+ * peek. */
+void handoff_pop(HandoffRing *ring);
+
+#endif /* HANDOFF_H */
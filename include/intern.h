@@ -0,0 +1,46 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+/*
+ * intern.h - vehicle ID string interning
+ *
+ * Vehicle IDs only matter at the edges of the system: they arrive as
+ * strings in protocol commands and leave as strings in departure output.
+ * Everything in between (queues, controller, copies) only needs a stable
+ * identity, so IDs are interned once at entry into a 32-bit handle and
+ * resolved back to a string at exit. This keeps the in-queue Vehicle
+ * small (see types.h) instead of dragging 32 ID bytes through every
+ * queue copy and controller scan.
+ *
+ * Properties:
+ *   - interning the same string twice returns the same handle
+ *   - returned string pointers stay valid for the life of the process
+ *     (storage is chunked and never moves)
+ *   - not thread-safe: intern on the control thread only; resolved
+ *     handles may be read from anywhere
+ *
+ * The table grows on the heap, which is fine for desktop builds. The
+ * embedded path synthesizes its own IDs and never reads them back;
+ * small-SRAM targets build with TSIM_NO_VEHICLE_IDS, which replaces the
+ * table with a bare counter (see intern.c) and drops both the heap and
+ * the per-arrival formatting.
+ */
+
+#include <stdint.h>
+
+/*
+ * Intern a NUL-terminated string and return its handle.
+ * Handle 0 is always the empty string.
+ */
+uint32_t vehicle_id_intern(const char *s);
+
+/*
+ * Resolve a handle back to its string.
+ * Returns "" for handles that were never issued.
+ */
+const char *vehicle_id_str(uint32_t handle);
+
+/* Number of distinct IDs interned so far. */
+uint32_t vehicle_id_count(void);
+
+#endif /* INTERN_H */
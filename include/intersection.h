@@ -21,6 +21,7 @@
  * simulation step and does not block vehicle departure from the new phase.
  */
 
+#include <stddef.h>
 #include "types.h"
 
 /*
@@ -30,6 +31,15 @@
  */
 void intersection_init(Intersection *inter);
 
+/*
+ * Replace the controller tuning parameters (init installs the config.h
+ * defaults). Sanitises nonsense input - min_green is raised to 1 and
+ * max_green to at least min_green - and pushes the yellow duration down
+ * into the four lights. Takes effect from the next phase decision.
+ */
+void intersection_set_params(Intersection *inter,
+                             const ControllerParams *params);
+
 /*
  * Add a vehicle entering from 'start' and heading to 'end'.
  * Returns false if:
@@ -41,6 +51,16 @@ bool intersection_add_vehicle(Intersection *inter,
                                RoadDir       end,
                                const char   *id);
 
+/*
+ * Same as intersection_add_vehicle(), but with an ID that has already
+ * been interned. Fast path for replay loops that resolve IDs once up
+ * front (see trace.h) instead of hashing the string per vehicle.
+ */
+bool intersection_add_vehicle_interned(Intersection *inter,
+                                       RoadDir       start,
+                                       RoadDir       end,
+                                       uint32_t      id);
+
 /*
  * Execute one simulation step.
  *
@@ -51,6 +71,43 @@ void intersection_step(Intersection *inter,
                        Vehicle       departed[MAX_DEPARTURES_PER_STEP],
                        uint8_t      *count);
 
+/*
+ * Per-departure callback for intersection_step_cb(). 'v' is valid only
+ * for the duration of the call: the lane queues store vehicle fields
+ * column-wise (see types.h), so there is no longer-lived Vehicle to
+ * point at. The callback fires mid-step, before step_count advances.
+ */
+typedef void (*DepartureFn)(void *user, RoadDir road, Lane lane,
+                            const Vehicle *v);
+
+/*
+ * Execute one simulation step, reporting each departure through
+ * 'on_departure' (must be non-NULL) instead of buffering it in an
+ * array. Consumers that forward departures elsewhere anyway - the
+ * protocol output writer, the grid handoff rings - process each
+ * vehicle where it is dequeued instead of copying it out and scanning
+ * the copy. intersection_step() is a thin wrapper over this.
+ */
+void intersection_step_cb(Intersection *inter, DepartureFn on_departure,
+                          void *user);
+
+/*
+ * Fast-forward through empty steps.
+ *
+ * Advances the intersection by up to max_steps steps, but only while no
+ * vehicle is queued - empty steps can never produce departures. An empty
+ * intersection settles into a periodic light schedule, so after walking
+ * at most a couple of periods normally the remaining whole periods are
+ * skipped with one addition to step_count instead of a loop. The
+ * resulting state is bit-identical to calling intersection_step() that
+ * many times.
+ *
+ * Returns the number of steps actually advanced: max_steps when the
+ * intersection is empty, 0 when it is not (the caller then steps
+ * normally).
+ */
+uint32_t intersection_fast_forward(Intersection *inter, uint32_t max_steps);
+
 /*
  * Add a vehicle directly into a specific lane, without knowing its destination.
  *
@@ -68,6 +125,43 @@ bool intersection_add_vehicle_by_lane(Intersection *inter,
                                       Lane          lane,
                                       const char   *id);
 
+/*
+ * Snapshot / restore
+ *
+ * Intersection is a flat, pointer-free struct, so a snapshot is a small
+ * versioned header, a raw copy of the state, and the queued vehicles'
+ * ID strings (interned handles are process-local, so blobs must carry
+ * the strings to restore in another process). Restoring a blob
+ * saved by a compatible build is an O(state-size) memcpy - what-if
+ * branching (restore, inject different traffic, compare) no longer
+ * needs to replay command history.
+ */
+
+/* Number of bytes intersection_save() would write for this state
+ * (varies with the queued vehicles' ID strings). */
+size_t intersection_snapshot_size(const Intersection *inter);
+
+/*
+ * Serialize the intersection into buf. Returns the number of bytes
+ * written, or 0 if cap is too small.
+ */
+size_t intersection_save(const Intersection *inter, void *buf, size_t cap);
+
+/*
+ * Restore state from a blob produced by intersection_save(). Returns
+ * false (leaving *inter untouched) if the blob has the wrong magic,
+ * version, or size - e.g. one saved by an incompatible build.
+ */
+bool intersection_load(Intersection *inter, const void *buf, size_t size);
+
+/*
+ * Recompute the cached per-lane and per-phase controller scores from the
+ * queues. The step/enqueue/dequeue paths keep the caches up to date on
+ * their own; call this only after mutating intersection state directly
+ * (tests patching fields, snapshot loads).
+ */
+void intersection_rebuild_scores(Intersection *inter);
+
 /* Current light state for a road, useful for display and debugging. */
 LightState intersection_light_state(const Intersection *inter, RoadDir road);
 
@@ -0,0 +1,90 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+/*
+ * journal.h - append-only command journal for crash recovery
+ *
+ * When the engine process dies, every queued vehicle and the whole
+ * light/phase state die with it; rebuilding a long session by resending
+ * commands from the API layer takes seconds. The journal appends one
+ * fixed-size binary record per accepted state-changing command
+ * (addVehicle, step) to an O_APPEND file with periodic fsync, and
+ * '--recover journal.bin' replays it at startup at memory bandwidth
+ * before resuming normal protocol operation on the same file.
+ *
+ * File layout: an 8-byte header (magic, version, record size) followed
+ * by 40-byte records. Unlike the trace format there is no string table -
+ * vehicle ids are stored inline so a record is complete the moment its
+ * write() returns, which is what append-only recovery requires. A torn
+ * final record from a crash mid-write is detected by size and dropped.
+ *
+ * A 'restore' protocol command replaces the whole state from a snapshot
+ * blob, which the journal cannot represent; the journal is truncated at
+ * that point, so recovery after a restore needs the snapshot plus the
+ * journal tail - the intended operating procedure anyway.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "types.h"
+
+#define JOURNAL_MAGIC   "TSJL"
+#define JOURNAL_VERSION 1
+
+enum {
+    JOURNAL_OP_ADD_VEHICLE = 1,   /* same values as TRACE_OP_* */
+    JOURNAL_OP_STEP        = 2,
+};
+
+typedef struct {
+    char     magic[4];
+    uint16_t version;
+    uint16_t record_size;
+} JournalHeader;
+
+typedef struct {
+    uint8_t  opcode;                  /* JOURNAL_OP_* */
+    uint8_t  start_road;              /* RoadDir, addVehicle only */
+    uint8_t  end_road;                /* RoadDir, addVehicle only */
+    uint8_t  reserved;
+    uint32_t arg;                     /* step: batch count */
+    char     id[MAX_VEHICLE_ID_LEN];  /* addVehicle: NUL-terminated */
+} JournalRecord;
+
+typedef struct {
+    FILE    *f;
+    uint32_t unsynced;   /* records appended since the last fsync */
+} Journal;
+
+/*
+ * Open a journal for appending. With 'truncate' the file is started
+ * fresh (--journal: new session); without it records are appended after
+ * the existing ones (--recover: resuming a replayed session).
+ * Returns 0 on success; on failure prints to stderr and returns non-zero.
+ */
+int journal_open(Journal *j, const char *path, bool truncate);
+
+/*
+ * Replay an existing journal into an intersection. Empty stretches are
+ * fast-forwarded; a torn or corrupt tail ends the replay rather than
+ * failing it. Returns the number of records applied, or -1 if the file
+ * cannot be read or has a bad header.
+ */
+int64_t journal_replay(const char *path, Intersection *inter);
+
+void journal_add_vehicle(Journal *j, RoadDir start, RoadDir end,
+                         const char *id);
+
+void journal_step(Journal *j, uint32_t count);
+
+/* Force the journal to disk now (also done every JOURNAL_SYNC_INTERVAL
+ * records). Called on the protocol's explicit 'flush'. */
+void journal_sync(Journal *j);
+
+/* Discard all records (after a 'restore' made them meaningless). */
+void journal_reset(Journal *j);
+
+void journal_close(Journal *j);
+
+#endif /* JOURNAL_H */
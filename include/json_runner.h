@@ -0,0 +1,50 @@
+#ifndef JSON_RUNNER_H
+#define JSON_RUNNER_H
+
+/*
+ * json_runner.h - native JSON scenario runner
+ *
+ * Runs a whole scenario file in-process, replacing the Python bridge for
+ * batch workloads: the input is loaded once, parsed with a small
+ * special-purpose scanner, executed against one Intersection, and the
+ * result written in the same {"stepStatuses": [...]} layout bridge.py
+ * produces — byte-for-byte, so downstream tooling can't tell them apart.
+ *
+ * The parser understands the documented scenario schema (a top-level
+ * "commands" array of objects with string fields); unknown keys and
+ * values are skipped, anything structurally malformed is an error.
+ */
+
+#include "config.h"
+
+/*
+ * Execute the scenario in input_path and write the result to output_path.
+ * Returns 0 on success; on failure prints a message to stderr and
+ * returns non-zero.
+ */
+int json_run_file(const char *input_path, const char *output_path);
+
+/*
+ * One parsed command object. Unrecognised types are passed through with
+ * their raw "type" string so consumers can decide what to skip.
+ */
+typedef struct {
+    char type[16];
+    char vehicle_id[MAX_VEHICLE_ID_LEN];
+    char start_road[16];
+    char end_road[16];
+} ScenarioCommand;
+
+typedef void (*scenario_command_fn)(const ScenarioCommand *cmd, void *user);
+
+/*
+ * Parse input_path and invoke fn for every entry of the "commands"
+ * array, in order. This is the parsing core behind json_run_file();
+ * other consumers (the trace converter) reuse it so there is exactly
+ * one scenario parser in the tree. Same return convention as
+ * json_run_file().
+ */
+int json_for_each_command(const char *input_path, scenario_command_fn fn,
+                          void *user);
+
+#endif /* JSON_RUNNER_H */
@@ -34,6 +34,14 @@ MovementType movement_type(RoadDir start, RoadDir end);
 /* Map a MovementType to the lane index it belongs to. */
 Lane lane_for_movement(MovementType movement);
 
+/*
+ * Protocol names for roads ("north"/"south"/"east"/"west").
+ * road_from_name() returns ROAD_NONE for anything it does not recognise;
+ * road_name() returns "none" for ROAD_NONE.
+ */
+RoadDir road_from_name(const char *name);
+const char *road_name(RoadDir dir);
+
 /*
  * "thread" for single-lane operations.
  */
@@ -66,6 +74,34 @@ bool queue_dequeue(VehicleQueue *q, Vehicle *out);
  */
 bool queue_peek(const VehicleQueue *q, Vehicle *out);
 
+/*
+ * Read the index-th queued vehicle (0 = front) without removing it.
+ * The queue stores its fields structure-of-arrays, so walkers that want
+ * whole vehicles (the state dump, snapshots) gather them through here
+ * instead of poking at the ring layout. Returns false past the end.
+ */
+bool queue_peek_at(const VehicleQueue *q, uint8_t index, Vehicle *out);
+
+/*
+ * Total steps waited so far by every vehicle in the queue, as of step
+ * 'now'. O(1): count * now minus the maintained enqueue_step_sum - the
+ * front vehicle's wait alone hides a lane full of long-waiting vehicles
+ * behind a fresh arrival, and this costs no ring scan to see through.
+ */
+uint64_t queue_total_wait(const VehicleQueue *q, uint32_t now);
+
+#if TSIM_SPILL_POOL
+/* Chain every pool node onto the free list. */
+void spill_pool_init(SpillPool *pool);
+
+/*
+ * Let a lane overflow into 'pool' when its inline ring fills. Without
+ * an attached pool the queue behaves exactly like the embedded build:
+ * enqueue into a full lane fails.
+ */
+void queue_attach_spill(VehicleQueue *q, SpillPool *pool);
+#endif
+
 /*
  * Road operations (all three lanes)
  */
@@ -97,4 +133,7 @@ uint8_t road_lane_count(const Road *r, Lane lane);
 /* Total number of vehicles waiting across all lanes of this road. */
 uint8_t road_total_count(const Road *r);
 
+/* Aggregate wait across all lanes of this road (see queue_total_wait). */
+uint64_t road_total_wait(const Road *r, uint32_t now);
+
 #endif /* ROAD_H */
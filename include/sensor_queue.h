@@ -0,0 +1,51 @@
+#ifndef SENSOR_QUEUE_H
+#define SENSOR_QUEUE_H
+
+/*
+ * sensor_queue.h - ISR-safe single-producer/single-consumer event queue
+ *
+ * Polling sense_lane() once per tick misses any vehicle that trips a
+ * sensor for less than one step interval. With this queue the sensor
+ * pins can be wired to edge interrupts instead: the ISR pushes a
+ * (road, lane, timestamp) record and simulation_tick() drains the
+ * queue at the start of every step.
+ *
+ * The ISR is the only producer and the tick is the only consumer, so
+ * the same acquire/release SPSC scheme as handoff.h applies - no IRQ
+ * masking and no locking around the queue state. Pushes into a full
+ * queue are rejected (the poll path still catches a sensor that stays
+ * occupied, so a dropped edge degrades to pre-interrupt behaviour).
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+
+typedef struct {
+    uint8_t  road;      /* RoadDir of the tripped sensor            */
+    uint8_t  lane;      /* Lane of the tripped sensor               */
+    uint16_t reserved;
+    uint32_t timestamp; /* capture time (HAL ticks), for diagnostics */
+} SensorEvent;
+
+/*
+ * Capacity is SENSOR_QUEUE_SIZE - 1 (one slot distinguishes full from
+ * empty). Must be a power of two.
+ */
+typedef struct {
+    SensorEvent      buf[SENSOR_QUEUE_SIZE];
+    _Atomic uint32_t head; /* consumer index */
+    _Atomic uint32_t tail; /* producer index */
+} SensorQueue;
+
+void sensor_queue_init(SensorQueue *queue);
+
+/* Producer side - safe to call from an interrupt handler.
+ * Returns false if the queue is full (event dropped). */
+bool sensor_queue_push(SensorQueue *queue, const SensorEvent *event);
+
+/* Consumer side. Returns false if the queue is empty. */
+bool sensor_queue_pop(SensorQueue *queue, SensorEvent *out);
+
+#endif /* SENSOR_QUEUE_H */
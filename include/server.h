@@ -0,0 +1,34 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+/*
+ * server.h - multi-session line protocol over one pipe
+ *
+ * The web backend used to spawn one traffic_sim process per simulation;
+ * at classroom scale that is hundreds of processes, pipes and scheduler
+ * entries doing identical work. Server mode keeps a pool of independent
+ * Intersection states in a single process and scopes every protocol
+ * command to one of them by session id:
+ *
+ *   create                                -> "created <id>"
+ *   destroy <id>                          -> "destroyed <id>"
+ *   addVehicle <id> <vehicle> <start> <end>
+ *   step <id> [N]                         -> one departure line per step
+ *   flush
+ *
+ * Commands are processed strictly in order, so responses arrive in
+ * command order and the client attributes them without tagging. Ids of
+ * destroyed sessions are reused. Commands naming an unknown session
+ * answer "error ..." rather than staying silent - a silently dropped
+ * 'step' would desync a client counting response lines.
+ */
+
+#include <stdio.h>
+
+/*
+ * Serve the session protocol from 'in' to 'out' until EOF.
+ * Returns 0 on success.
+ */
+int server_run(FILE *in, FILE *out);
+
+#endif /* SERVER_H */
@@ -0,0 +1,95 @@
+#ifndef SIM_API_H
+#define SIM_API_H
+
+/*
+ * sim_api.h - stable C API for in-process embedding
+ *
+ * A thin, ABI-stable facade over Intersection, built into the
+ * traffic_sim_shared library so host processes (the web backend via
+ * ctypes/cffi, or any other language runtime) can drive the engine
+ * with plain function calls instead of a subprocess and a text pipe.
+ *
+ * Conventions:
+ *   - the simulation handle is opaque; all state lives behind it
+ *   - roads are passed as protocol names ("north", "south", ...)
+ *   - every struct crossing the boundary is flat and fixed-size so
+ *     ctypes can describe it without a header parser
+ *
+ * This header intentionally exposes nothing from types.h: the internal
+ * layout of Intersection may change without breaking embedders.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Sim Sim;
+
+/*
+ * Flat snapshot of the externally visible intersection state.
+ * lights[] and lane_counts[] are indexed by road (0=N, 1=S, 2=E, 3=W)
+ * and lane (0=left, 1=straight, 2=right); light values follow the
+ * LightState enum (0=RED, 1=YELLOW, 2=GREEN, 3=GREEN_ARROW).
+ */
+typedef struct {
+    uint32_t step_count;
+    uint8_t  current_phase;     /* Phase enum: 0=NS 1=EW 2=NS_ARROW 3=EW_ARROW */
+    uint8_t  lights[4];
+    uint8_t  lane_counts[4][3];
+    uint8_t  total_waiting;
+} SimStateView;
+
+/* Allocate and initialise a simulation. Returns NULL on allocation failure. */
+Sim *sim_create(void);
+
+/* Free a simulation. NULL is a no-op. */
+void sim_destroy(Sim *sim);
+
+/* Reset a simulation to its initial (empty, all-red) state. */
+void sim_reset(Sim *sim);
+
+/*
+ * Add a vehicle entering from 'start_road' heading to 'end_road'
+ * (protocol names). Returns 1 on success, 0 if the movement is invalid
+ * or the target lane is full.
+ */
+int sim_add_vehicle(Sim *sim, const char *start_road, const char *end_road,
+                    const char *vehicle_id);
+
+/*
+ * Run one simulation step. The IDs of departing vehicles are written to
+ * 'departed' as a space-separated, NUL-terminated string (pass NULL to
+ * discard them). Returns the number of departures.
+ */
+int sim_step(Sim *sim, char *departed, int departed_cap);
+
+/* Fill *out with the current externally visible state. */
+void sim_state(const Sim *sim, SimStateView *out);
+
+/*
+ * Wait-time statistics for vehicles that departed from one road.
+ * Waits are counted in simulation steps; percentiles are upper bounds
+ * accurate to a power of two (see waithist.h).
+ */
+typedef struct {
+    uint64_t count;        /* departures recorded                    */
+    uint64_t total_steps;  /* sum of all waits, for exact averages   */
+    uint32_t max_steps;
+    uint32_t p50;
+    uint32_t p95;
+    uint32_t p99;
+} SimWaitStats;
+
+/*
+ * Fill *out with wait-time statistics for 'road' (protocol name).
+ * Returns 1 on success, 0 for an unknown road name.
+ */
+int sim_wait_stats(const Sim *sim, const char *road, SimWaitStats *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_API_H */
@@ -22,17 +22,19 @@
 #include <stdbool.h>
 #include "types.h"
 #include "hal.h"
+#include "sensor_queue.h"
 
 /*
  * SimulationContext - all mutable state for one intersection instance.
  *
  * Intended to be a single static or global on embedded targets.
  * Contains the intersection state, per-lane edge-detection flags,
- * and a monotonic vehicle ID counter.
+ * the ISR-fed sensor event queue, and a monotonic vehicle ID counter.
  */
 typedef struct {
     Intersection inter;
     bool         prev_sense[ROAD_COUNT][LANES_PER_ROAD];
+    SensorQueue  sensor_events;
     uint32_t     vehicle_counter;
 } SimulationContext;
 
@@ -44,10 +46,24 @@ void simulation_init(SimulationContext *ctx);
  *
  * Must be called at a fixed real-time interval (e.g. every 2 seconds).
  * Steps:
- *   1. Poll all lane sensors; enqueue one vehicle per rising edge.
- *   2. Call intersection_step() to advance the controller and lights.
- *   3. Call hal->set_light() for every road to update physical outputs.
+ *   1. Drain the sensor event queue; enqueue one vehicle per event.
+ *   2. Poll all lane sensors; enqueue one vehicle per rising edge.
+ *   3. Call intersection_step() to advance the controller and lights.
+ *   4. Call hal->set_light() for every road to update physical outputs.
  */
 void simulation_tick(SimulationContext *ctx, const EmbeddedHAL *hal);
 
+/*
+ * Record a sensor edge from an interrupt handler.
+ *
+ * ISR-safe: pushes onto a lock-free SPSC queue, never blocks and never
+ * needs IRQs masked. Call from the EXTI handler of the lane's sensor
+ * pin with any monotonic timestamp (e.g. HAL_GetTick()); the vehicle is
+ * enqueued on the next simulation_tick(). Events that catch a sensor
+ * still occupied at the next poll are not double-counted. Returns false
+ * if the queue is full and the event was dropped.
+ */
+bool simulation_sensor_isr(SimulationContext *ctx, RoadDir road, Lane lane,
+                           uint32_t timestamp);
+
 #endif /* SIMULATION_H */
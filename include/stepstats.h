@@ -0,0 +1,105 @@
+#ifndef STEPSTATS_H
+#define STEPSTATS_H
+
+/*
+ * stepstats.h - optional per-stage timing inside intersection_step()
+ *
+ * When a deployment slows down, the first question is where the step
+ * time goes: controller decision, the dequeue pass, light ticking, or
+ * score maintenance. Built with TSIM_STEP_TIMING (CMake option of the
+ * same name) each stage is bracketed with a monotonic clock read and
+ * accumulated into per-stage counters plus a log2-bucketed latency
+ * histogram carried by the Intersection. The protocol's 'stats'
+ * command dumps them; embedded code reads inter->step_stats directly.
+ *
+ * Without the option nothing is compiled in at all - no struct field,
+ * no clock reads - so the default build pays zero overhead. When
+ * enabled the cost per stage is two clock reads and four increments.
+ *
+ * stepstats_now_ns() defaults to CLOCK_MONOTONIC; ports without one
+ * (e.g. bare-metal Cortex-M using DWT->CYCCNT) can predefine
+ * TSIM_STEPSTATS_NOW to any monotonic uint64_t expression - the
+ * buckets then count that unit instead of nanoseconds.
+ */
+
+#include <stdint.h>
+
+enum {
+    STEP_STAGE_CONTROLLER = 0, /* phase decision + apply           */
+    STEP_STAGE_DEQUEUE    = 1, /* green-lane departures            */
+    STEP_STAGE_LIGHTS     = 2, /* traffic light FSM ticks          */
+    STEP_STAGE_SCORES     = 3, /* cached score aging               */
+    STEP_STAGE_COUNT      = 4,
+};
+
+#define STEP_STATS_BUCKETS 32  /* bucket b holds durations < 2^b ns */
+
+typedef struct {
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t hist[STEP_STATS_BUCKETS];
+} StageStats;
+
+typedef struct {
+    StageStats stages[STEP_STAGE_COUNT];
+} StepStats;
+
+static inline const char *stepstats_stage_name(int stage) {
+    switch (stage) {
+        case STEP_STAGE_CONTROLLER: return "controller";
+        case STEP_STAGE_DEQUEUE:    return "dequeue";
+        case STEP_STAGE_LIGHTS:     return "lights";
+        case STEP_STAGE_SCORES:     return "scores";
+        default:                    return "unknown";
+    }
+}
+
+#if TSIM_STEP_TIMING
+
+#ifdef TSIM_STEPSTATS_NOW
+static inline uint64_t stepstats_now_ns(void) {
+    return (uint64_t)(TSIM_STEPSTATS_NOW);
+}
+#else
+#include <time.h>
+static inline uint64_t stepstats_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+static inline void stepstats_record(StepStats *stats, int stage,
+                                    uint64_t start_ns, uint64_t end_ns) {
+    StageStats *s  = &stats->stages[stage];
+    uint64_t    ns = end_ns - start_ns;
+
+    s->count++;
+    s->total_ns += ns;
+    if (ns > s->max_ns) {
+        s->max_ns = ns;
+    }
+    int bucket = 0;
+    while (bucket < STEP_STATS_BUCKETS - 1 && (ns >> bucket) > 0) {
+        bucket++;
+    }
+    s->hist[bucket]++;
+}
+
+/* Bracket a stage inside intersection_step(). */
+#define STEP_TIMER_DECL     uint64_t _stage_start
+#define STEP_TIMER_START()  (_stage_start = stepstats_now_ns())
+#define STEP_TIMER_STOP(inter, stage)                                       \
+    stepstats_record(&(inter)->step_stats, stage, _stage_start,             \
+                     stepstats_now_ns())
+
+#else /* !TSIM_STEP_TIMING: everything compiles away */
+
+#define STEP_TIMER_DECL              int _stage_unused __attribute__((unused))
+#define STEP_TIMER_START()           ((void)0)
+#define STEP_TIMER_STOP(inter, stage) ((void)0)
+
+#endif /* TSIM_STEP_TIMING */
+
+#endif /* STEPSTATS_H */
@@ -0,0 +1,36 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+/*
+ * sweep.h - parallel controller-parameter sweep over a recorded trace
+ *
+ * Site calibration means replaying one recorded scenario under many
+ * candidate controller settings and comparing the outcomes. With the
+ * tuning knobs now carried at runtime (ControllerParams), one process
+ * can try the full candidate grid without a rebuild: the trace is
+ * mmapped once, the cartesian product of the candidate values is
+ * distributed across all cores, and every combination replays into its
+ * own private Intersection.
+ *
+ * The parameter file is a JSON object with one array of candidate
+ * values per knob:
+ *
+ *   { "min_green": [1, 2, 3], "max_green": [4, 6, 8], "yellow": [1, 2] }
+ *
+ * Combinations where max_green < min_green are skipped. Results are
+ * written as CSV, one row per combination in grid order regardless of
+ * which worker ran it:
+ *
+ *   min_green,max_green,yellow,steps,departed,remaining,avg_wait,max_wait
+ */
+
+#include <stdio.h>
+
+/*
+ * Replay trace_path under every parameter combination in params_path
+ * and write the CSV report to 'out'. Returns 0 on success; on failure
+ * prints a message to stderr and returns non-zero.
+ */
+int sweep_run(const char *params_path, const char *trace_path, FILE *out);
+
+#endif /* SWEEP_H */
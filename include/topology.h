@@ -0,0 +1,37 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+/*
+ * topology.h - compile-time view of the phase/lane topology
+ *
+ * PHASE_INFO is a runtime table, but the topology it describes is fixed
+ * by config.h at build time. This header expresses the same mapping as
+ * X-macros - one (road, lane) pair per lane a phase serves - so the
+ * per-tick score and departure paths can be fully unrolled with every
+ * road and lane index a literal constant: no loop over road_count, no
+ * is_arrow branch, and the scoring sums become straight-line code the
+ * compiler can vectorize.
+ *
+ * The unrolled paths are compiled in when TSIM_SPECIALIZE_TOPOLOGY is
+ * defined (CMake option of the same name); otherwise the generic
+ * PHASE_INFO walks are used. Both must stay in sync with PHASE_INFO in
+ * src/controller.c; the controller and intersection test suites pass
+ * unchanged in either configuration.
+ */
+
+/* Lanes served by each phase, as X(road, lane) invocations. */
+#define TOPOLOGY_NS_LANES(X)                                                \
+    X(ROAD_NORTH, LANE_STRAIGHT) X(ROAD_NORTH, LANE_RIGHT)                  \
+    X(ROAD_SOUTH, LANE_STRAIGHT) X(ROAD_SOUTH, LANE_RIGHT)
+
+#define TOPOLOGY_EW_LANES(X)                                                \
+    X(ROAD_EAST, LANE_STRAIGHT) X(ROAD_EAST, LANE_RIGHT)                    \
+    X(ROAD_WEST, LANE_STRAIGHT) X(ROAD_WEST, LANE_RIGHT)
+
+#define TOPOLOGY_NS_ARROW_LANES(X)                                          \
+    X(ROAD_NORTH, LANE_LEFT) X(ROAD_SOUTH, LANE_LEFT)
+
+#define TOPOLOGY_EW_ARROW_LANES(X)                                          \
+    X(ROAD_EAST, LANE_LEFT) X(ROAD_WEST, LANE_LEFT)
+
+#endif /* TOPOLOGY_H */
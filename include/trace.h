@@ -0,0 +1,115 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/*
+ * trace.h - compact binary trace format for scenarios and replays
+ *
+ * Recorded real-world scenarios run to hundreds of millions of events;
+ * parsing them as JSON or line text is minutes of startup before the
+ * first step executes. The trace format stores fixed-size 8-byte
+ * records plus one string table, so loading is a single mmap and replay
+ * reads records straight out of the page cache.
+ *
+ * File layout (all fields little-endian, written natively):
+ *
+ *   TraceHeader                      24 bytes
+ *   TraceRecord[record_count]        8 bytes each
+ *   string table                     string_count NUL-terminated IDs,
+ *                                    concatenated in handle order
+ *
+ * Records reference vehicle IDs by their index into the string table,
+ * so the per-record cost of an addVehicle is one array lookup at replay
+ * time. "step" records carry a repeat count, mirroring the batched
+ * 'step N' protocol command.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "types.h"
+
+#define TRACE_MAGIC   "TSIM"
+#define TRACE_VERSION 1
+
+enum {
+    TRACE_OP_ADD_VEHICLE = 1,
+    TRACE_OP_STEP        = 2,   /* arg = number of steps (>= 1) */
+};
+
+typedef struct {
+    char     magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    uint64_t record_count;
+    uint32_t string_count;
+    uint32_t reserved2;
+} TraceHeader;
+
+typedef struct {
+    uint8_t  opcode;      /* TRACE_OP_* */
+    uint8_t  start_road;  /* RoadDir, addVehicle only */
+    uint8_t  end_road;    /* RoadDir, addVehicle only */
+    uint8_t  reserved;
+    uint32_t arg;         /* addVehicle: string-table index; step: count */
+} TraceRecord;
+
+/*
+ * Reading
+ */
+
+/* An open, memory-mapped trace. */
+typedef struct {
+    const TraceRecord *records;
+    uint64_t           record_count;
+    uint32_t          *id_map;       /* file handle -> interned handle */
+    uint32_t           id_count;
+    void              *map_base;
+    size_t             map_size;
+} Trace;
+
+/*
+ * mmap trace_path and validate the header. The string table is interned
+ * once up front so replay resolves IDs with one array lookup.
+ * Returns 0 on success; on failure prints to stderr and returns non-zero.
+ */
+int trace_open(Trace *trace, const char *path);
+
+void trace_close(Trace *trace);
+
+/*
+ * Replay a trace into an intersection. Departure output goes to 'out'
+ * (one line per step, same format as the line protocol); pass NULL to
+ * run without output, e.g. for timing studies.
+ * Returns the number of steps executed.
+ */
+uint64_t trace_replay(const Trace *trace, Intersection *inter, FILE *out);
+
+/*
+ * Writing
+ */
+
+typedef struct {
+    FILE     *f;
+    uint64_t  record_count;
+    uint32_t *file_handle;   /* interned handle -> file string index */
+    uint32_t  file_handle_cap;
+    const char **strings;    /* file string index -> interned string */
+    uint32_t  strings_cap;
+    uint32_t  string_count;
+    uint32_t  pending_steps; /* consecutive steps coalesced into one record */
+} TraceWriter;
+
+/* Create trace_path and write a placeholder header. Returns 0 on success. */
+int trace_writer_open(TraceWriter *w, const char *path);
+
+void trace_writer_add_vehicle(TraceWriter *w, RoadDir start, RoadDir end,
+                              const char *id);
+
+void trace_writer_step(TraceWriter *w, uint32_t count);
+
+/* Flush records, append the string table, finalise the header. */
+int trace_writer_close(TraceWriter *w);
+
+/* Convert a JSON scenario (bridge.py schema) to a binary trace. */
+int trace_convert_json(const char *json_path, const char *trace_path);
+
+#endif /* TRACE_H */
@@ -49,7 +49,8 @@ void traffic_light_set_green_arrow(TrafficLight *tl, uint8_t duration);
  *
  * Transitions:
  *   GREEN / GREEN_ARROW: decrement steps_remaining;
- *                        when it reaches 0 -> YELLOW (steps = YELLOW_STEPS)
+ *                        when it reaches 0 -> YELLOW for yellow_steps
+ *                        steps (default YELLOW_STEPS)
  *   YELLOW:              decrement steps_remaining;
  *                        when it reaches 0 -> RED
  *   RED:                 no-op
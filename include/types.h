@@ -10,6 +10,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "config.h"
+#include "waithist.h"
+#if TSIM_STEP_TIMING
+#include "stepstats.h"
+#endif
 
 // Roads
 typedef enum {
@@ -44,26 +48,83 @@ typedef enum {
     LANE_RIGHT    = 2
 } Lane;
 
-// Vehicles
+/*
+ * Vehicles
+ *
+ * IDs are interned (see intern.h): the queue-resident struct carries a
+ * 32-bit handle instead of MAX_VEHICLE_ID_LEN bytes of string, so a full
+ * lane fits in a few cache lines and queue copies stay cheap. The enums
+ * are stored as uint8_t for the same reason; they always hold RoadDir /
+ * MovementType values.
+ */
 typedef struct {
-    char         id[MAX_VEHICLE_ID_LEN];
-    RoadDir      end_road;
-    MovementType movement;     /* derived once at enqueue, never changes  */
+    uint32_t     id;           /* interned handle, resolve via vehicle_id_str() */
+    uint8_t      end_road;     /* RoadDir */
+    uint8_t      movement;     /* MovementType; derived once at enqueue */
     uint32_t     enqueue_step; /* simulation step at which vehicle was added */
 } Vehicle;
 
+#if TSIM_SPILL_POOL
+/*
+ * Overflow spill pool (desktop builds only)
+ *
+ * One fixed slab shared by all 12 lanes of an intersection. A lane
+ * whose inline ring fills overflows into a per-lane FIFO list of pool
+ * nodes and refills the ring from it on dequeue, so a hot lane can
+ * grow SPILL_POOL_SIZE deep without multiplying the inline footprint
+ * of every lane the way raising MAX_VEHICLES_PER_LANE would.
+ *
+ * All links are node index + 1 so that zeroed state means "none".
+ */
+typedef struct {
+    Vehicle vehicle;
+    uint8_t next;       /* next node in the lane FIFO; 0 = end */
+} SpillNode;
+
+typedef struct SpillPool {
+    SpillNode nodes[SPILL_POOL_SIZE];
+    uint8_t   free_head; /* first free node; 0 = pool exhausted */
+} SpillPool;
+#endif
+
 /*
  * Fixed-size ring-buffer queue for one lane. All storage is inline.
  *
- *   head  - index of the next vehicle to dequeue
- *   tail  - index where the next vehicle will be enqueued
+ * The ring is stored structure-of-arrays: parallel ids / enqueue_steps /
+ * end_roads / movements arrays indexed by the same slot, rather than an
+ * array of Vehicle. Scans that only need one field (wait accounting and
+ * score rebuilds read enqueue_steps, the state dump reads ids) then
+ * stream one dense array through cache instead of dragging the whole
+ * 12-byte record per vehicle, and a loop over enqueue_steps is plain
+ * uint32 arithmetic the compiler can vectorize. Whole vehicles cross
+ * the queue_* API boundary as Vehicle values, gathered and scattered at
+ * the edges (see queue_slot_load/store in road.c), so callers never see
+ * the split.
+ *
+ *   head  - slot of the next vehicle to dequeue
+ *   tail  - slot where the next vehicle will be enqueued
  *   count - number of vehicles currently in the queue
+ *
+ * enqueue_step_sum is the running sum of enqueue_step over the queued
+ * vehicles, maintained O(1) on enqueue/dequeue so the aggregate wait of
+ * the whole lane is one subtraction (see queue_total_wait()) instead of
+ * a ring scan.
  */
 typedef struct {
-    Vehicle buf[MAX_VEHICLES_PER_LANE];
-    uint8_t head;
-    uint8_t tail;
-    uint8_t count;
+    uint32_t ids[MAX_VEHICLES_PER_LANE];           /* interned handles  */
+    uint32_t enqueue_steps[MAX_VEHICLES_PER_LANE];
+    uint8_t  end_roads[MAX_VEHICLES_PER_LANE];     /* RoadDir values    */
+    uint8_t  movements[MAX_VEHICLES_PER_LANE];     /* MovementType      */
+    uint64_t enqueue_step_sum;
+    uint8_t  head;
+    uint8_t  tail;
+    uint8_t  count;
+#if TSIM_SPILL_POOL
+    struct SpillPool *spill;  /* shared pool; NULL = no overflow     */
+    uint8_t  spill_head;      /* lane FIFO through the pool (idx+1)  */
+    uint8_t  spill_tail;
+    uint8_t  spill_count;
+#endif
 } VehicleQueue;
 
 // One road = three lane queues, indexed by Lane enum.
@@ -83,6 +144,7 @@ typedef enum {
 typedef struct {
     LightState state;
     uint8_t    steps_remaining;   /* steps left in the current state */
+    uint8_t    yellow_steps;      /* YELLOW duration after green ends */
 } TrafficLight;
 
 /*
@@ -100,17 +162,69 @@ typedef enum {
 } Phase;
 
 /*
- * Intersection 
+ * ControllerParams
+ *
+ * Runtime copies of the controller tuning knobs. config.h supplies the
+ * defaults; carrying them per intersection lets a calibration run try
+ * many candidates without a rebuild (see the --sweep driver).
+ */
+typedef struct {
+    uint8_t min_green_steps;
+    uint8_t max_green_steps;
+    uint8_t yellow_steps;
+} ControllerParams;
+
+/*
+ * Intersection
  *
  * A complete, self-contained simulation state.
  */
 typedef struct {
-    Road         roads[ROAD_COUNT];
-    TrafficLight lights[ROAD_COUNT];
+    Road             roads[ROAD_COUNT];
+    TrafficLight     lights[ROAD_COUNT];
+    ControllerParams params;
     Phase        current_phase;
     uint8_t      phase_steps_remaining;
     bool         in_yellow_transition;
     uint32_t     step_count;
+
+    /*
+     * Cached controller scores, maintained incrementally on enqueue,
+     * dequeue, and step tick (see intersection.c). phase_scores[p] is
+     * always equal to controller_phase_score(inter, p); lane_scores
+     * holds the per-lane contributions so updates are O(1) deltas.
+     * Rebuild with intersection_rebuild_scores() after patching state
+     * directly (e.g. loading a snapshot).
+     */
+    uint32_t     lane_scores[ROAD_COUNT][LANES_PER_ROAD];
+    uint32_t     phase_scores[PHASE_COUNT];
+
+    /*
+     * Packed copy of the 12 lane counts (index road * LANES_PER_ROAD +
+     * lane; the 4 pad bytes stay zero), maintained alongside the queues
+     * so count reductions are one 16-byte vector op (see countvec.h)
+     * instead of twelve scattered fetches.
+     */
+    uint8_t      lane_counts[16];
+
+    /*
+     * Wait-time telemetry, indexed by the departing vehicle's start
+     * road (see waithist.h). Always compiled in: recording is a few
+     * increments per departure with no clock reads, unlike the
+     * TSIM_STEP_TIMING instrumentation above.
+     */
+    WaitHist     wait_hists[ROAD_COUNT];
+
+#if TSIM_SPILL_POOL
+    /* Shared overflow slab; every lane's spill pointer refers here. */
+    SpillPool    spill_pool;
+#endif
+
+#if TSIM_STEP_TIMING
+    /* Per-stage step timing, only present in instrumented builds
+     * (see stepstats.h). */
+    StepStats    step_stats;
+#endif
 } Intersection;
 
 #endif /* TYPES_H */
@@ -0,0 +1,79 @@
+#ifndef WAITHIST_H
+#define WAITHIST_H
+
+/*
+ * waithist.h - per-road vehicle wait-time histograms
+ *
+ * "How long do vehicles wait, and is the tail getting worse?" is the
+ * operational question; averages hide exactly the tail that matters.
+ * Rather than log every departure (unbounded memory, I/O in the hot
+ * path), each road carries a compact log2-bucketed histogram: at
+ * dequeue time the wait is already in hand as step_count minus the
+ * vehicle's enqueue_step, and recording it is a handful of increments.
+ * Percentiles are computed on demand by walking the 32 buckets, so the
+ * per-departure cost stays O(1) and the memory constant regardless of
+ * how long the simulation runs.
+ *
+ * Bucketing matches stepstats.h: bucket b holds waits < 2^b steps, so
+ * a reported percentile is an upper bound that is at most one power of
+ * two above the true value - coarse, but plenty to see a p99 drift
+ * from 8 steps to 100. The exact count, sum and max are kept alongside
+ * for precise averages.
+ *
+ * Surfaced by the protocol's 'waitHist' command and sim_wait_stats()
+ * in the shared-library API; embedded code reads inter->wait_hists
+ * directly.
+ */
+
+#include <stdint.h>
+
+#define WAIT_HIST_BUCKETS 32  /* bucket b holds waits < 2^b steps */
+
+typedef struct {
+    uint64_t count;
+    uint64_t total;                      /* sum of waits, in steps */
+    uint32_t max;
+    uint64_t buckets[WAIT_HIST_BUCKETS];
+} WaitHist;
+
+static inline void waithist_record(WaitHist *h, uint32_t wait) {
+    h->count++;
+    h->total += wait;
+    if (wait > h->max) {
+        h->max = wait;
+    }
+    int bucket = 0;
+    while (bucket < WAIT_HIST_BUCKETS - 1 && (wait >> bucket) > 0) {
+        bucket++;
+    }
+    h->buckets[bucket]++;
+}
+
+/*
+ * Wait at or below which a fraction p (0 < p <= 1) of recorded
+ * departures fall, reported as the upper bound of the bucket holding
+ * the p-th sample. Returns 0 for an empty histogram.
+ */
+static inline uint32_t waithist_percentile(const WaitHist *h, double p) {
+    if (h->count == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t)(p * (double)h->count + 0.5);
+    if (rank < 1) {
+        rank = 1;
+    }
+    if (rank > h->count) {
+        rank = h->count;
+    }
+    uint64_t seen = 0;
+    for (int b = 0; b < WAIT_HIST_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= rank) {
+            /* Bucket b covers [2^(b-1), 2^b); its largest wait is 2^b - 1. */
+            return b == 0 ? 0 : (uint32_t)((1u << b) - 1);
+        }
+    }
+    return h->max;
+}
+
+#endif /* WAITHIST_H */
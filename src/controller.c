@@ -1,5 +1,7 @@
 #include "controller.h"
+#include "countvec.h"
 #include "road.h"
+#include "topology.h"
 
 /* Phase metadata table */
 const PhaseInfo PHASE_INFO[PHASE_COUNT] = {
@@ -29,31 +31,55 @@ static uint32_t score_lane(const Road *road, Lane lane, uint32_t step_count) {
     return (uint32_t)count * (1u + wait);
 }
 
+/*
+ * Byte masks over the packed lane-count vector (road * LANES_PER_ROAD +
+ * lane), selecting the lanes each phase serves. Must stay in sync with
+ * PHASE_INFO; index order is N(0-2) S(3-5) E(6-8) W(9-11).
+ */
+static const uint8_t PHASE_LANE_MASK[PHASE_COUNT][16] = {
+    /*                 N.l N.s N.r S.l S.s S.r E.l E.s E.r W.l W.s W.r */
+    [PHASE_NS]      = {  0, 255, 255,  0, 255, 255,  0,  0,  0,  0,  0,  0 },
+    [PHASE_EW]      = {  0,  0,  0,  0,  0,  0,  0, 255, 255,  0, 255, 255 },
+    [PHASE_NS_ARROW] = { 255,  0,  0, 255,  0,  0,  0,  0,  0,  0,  0,  0 },
+    [PHASE_EW_ARROW] = {  0,  0,  0,  0,  0,  0, 255,  0,  0, 255,  0,  0 },
+};
+
 /*
  * Total number of vehicles in the lanes that would be served by 'phase'.
- * Used to calculate green duration.
+ * Used to calculate green duration. One masked vector reduction over
+ * the packed count vector.
  */
 static uint8_t phase_vehicle_count(const Intersection *inter, Phase phase) {
-    const PhaseInfo *info = &PHASE_INFO[phase];
-    uint8_t total = 0;
+    return (uint8_t)countvec_sum_masked(inter->lane_counts,
+                                        PHASE_LANE_MASK[phase]);
+}
 
-    for (int r = 0; r < info->road_count; r++) {
-        RoadDir dir       = info->roads[r];
-        const Road *road  = &inter->roads[dir];
 
-        if (info->is_arrow) {
-            total += road_lane_count(road, LANE_LEFT);
-        } else {
-            total += road_lane_count(road, LANE_STRAIGHT);
-            total += road_lane_count(road, LANE_RIGHT);
-        }
-    }
+/* Let's name that as API */
+#if TSIM_SPECIALIZE_TOPOLOGY
 
-    return total;
+/* Unrolled via topology.h: every road/lane index is a literal, so the
+ * sums are straight-line code with no table walk or is_arrow branch. */
+#define SCORE_ONE(road_, lane_)                                             \
+    score += score_lane(&inter->roads[road_], lane_, inter->step_count);
+
+uint32_t controller_phase_score(const Intersection *inter, Phase phase) {
+    uint32_t score = 0;
+
+    switch (phase) {
+        case PHASE_NS:       TOPOLOGY_NS_LANES(SCORE_ONE)       break;
+        case PHASE_EW:       TOPOLOGY_EW_LANES(SCORE_ONE)       break;
+        case PHASE_NS_ARROW: TOPOLOGY_NS_ARROW_LANES(SCORE_ONE) break;
+        case PHASE_EW_ARROW: TOPOLOGY_EW_ARROW_LANES(SCORE_ONE) break;
+        default: break;
+    }
+    return score;
 }
 
+#undef SCORE_ONE
+
+#else /* generic PHASE_INFO walk */
 
-/* Let's name that as API */
 uint32_t controller_phase_score(const Intersection *inter, Phase phase) {
     if (phase >= PHASE_COUNT) {
         return 0;
@@ -76,12 +102,22 @@ uint32_t controller_phase_score(const Intersection *inter, Phase phase) {
     return score;
 }
 
+#endif /* TSIM_SPECIALIZE_TOPOLOGY */
+
+Phase controller_phase_for_lane(RoadDir road, Lane lane) {
+    bool ns = (road == ROAD_NORTH || road == ROAD_SOUTH);
+    if (lane == LANE_LEFT) {
+        return ns ? PHASE_NS_ARROW : PHASE_EW_ARROW;
+    }
+    return ns ? PHASE_NS : PHASE_EW;
+}
+
 PhaseDecision controller_next_phase(const Intersection *inter) {
     Phase    best_phase = inter->current_phase;
-    uint32_t best_score = controller_phase_score(inter, inter->current_phase);
+    uint32_t best_score = inter->phase_scores[inter->current_phase];
 
     for (int p = 0; p < PHASE_COUNT; p++) {
-        uint32_t score = controller_phase_score(inter, (Phase)p);
+        uint32_t score = inter->phase_scores[p];
 
         /*
          * Strict greater-than: the current phase wins ties, avoiding
@@ -93,9 +129,10 @@ PhaseDecision controller_next_phase(const Intersection *inter) {
         }
     }
 
+    const ControllerParams *p = &inter->params;
     uint8_t count    = phase_vehicle_count(inter, best_phase);
-    uint8_t duration = count < MIN_GREEN_STEPS ? MIN_GREEN_STEPS
-                     : count > MAX_GREEN_STEPS ? MAX_GREEN_STEPS
+    uint8_t duration = count < p->min_green_steps ? p->min_green_steps
+                     : count > p->max_green_steps ? p->max_green_steps
                      : count;
 
     PhaseDecision decision = { best_phase, duration };
@@ -0,0 +1,330 @@
+#include "grid.h"
+#include "handoff.h"
+#include "intersection.h"
+#include "road.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Worker model: the pool is created once in grid_create() and parked on
+ * a barrier. grid_step() trips the start barrier, every worker steps
+ * its fixed [begin, end) cell range, and the done barrier hands control
+ * back. Static partitioning keeps the workers contention-free: no two
+ * workers ever touch the same cell, and cells are cache-line aligned so
+ * they don't share lines either.
+ */
+
+typedef struct {
+    Grid    *grid;
+    uint32_t begin; /* first cell index owned by this worker */
+    uint32_t end;   /* one past the last                     */
+} GridWorker;
+
+struct Grid {
+    uint16_t      width;
+    uint16_t      height;
+    uint32_t      cell_count;
+    Intersection *cells;            /* cache-line aligned, row-major */
+
+    /* Per-cell departure buffers for the latest step. */
+    Vehicle     (*departed)[MAX_DEPARTURES_PER_STEP];
+    uint8_t      *departed_count;
+
+    /*
+     * Handoff state (NULL until grid_enable_handoff()). rings is
+     * indexed [cell * ROAD_COUNT + exit_dir]: the ring carrying
+     * vehicles leaving 'cell' toward 'exit_dir'. Per-cell exit/drop
+     * counters avoid any shared counter between workers.
+     */
+    HandoffRing *rings;
+    uint32_t     travel_delay;
+    uint64_t    *exited;
+    uint64_t    *dropped;
+
+    /* Worker pool (unused when worker_count == 0). */
+    int               worker_count;
+    pthread_t         threads[GRID_MAX_WORKERS];
+    GridWorker        workers[GRID_MAX_WORKERS];
+    pthread_barrier_t start_barrier;
+    pthread_barrier_t done_barrier;
+    bool              shutting_down;
+};
+
+/* Grid geometry: y grows southward, x grows eastward. Returns false if
+ * leaving 'cell' toward 'dir' crosses the grid boundary. */
+static bool neighbor_of(const Grid *grid, uint32_t cell, RoadDir dir,
+                        uint32_t *out) {
+    uint32_t x = cell % grid->width;
+    uint32_t y = cell / grid->width;
+    switch (dir) {
+        case ROAD_NORTH: if (y == 0) return false;                y--; break;
+        case ROAD_SOUTH: if (y == grid->height - 1u) return false; y++; break;
+        case ROAD_EAST:  if (x == grid->width - 1u) return false;  x++; break;
+        case ROAD_WEST:  if (x == 0) return false;                x--; break;
+        default: return false;
+    }
+    *out = y * grid->width + x;
+    return true;
+}
+
+static const RoadDir OPPOSITE[ROAD_COUNT] = {
+    [ROAD_NORTH] = ROAD_SOUTH, [ROAD_SOUTH] = ROAD_NORTH,
+    [ROAD_EAST]  = ROAD_WEST,  [ROAD_WEST]  = ROAD_EAST,
+};
+
+/*
+ * Move arrived vehicles from the cell's four incoming rings into its
+ * road queues. Runs on the consumer worker just before the cell steps;
+ * fresh pushes from racing producers carry a future arrival_step, so
+ * they are never consumed early and stepping stays deterministic.
+ */
+static void drain_ingress(Grid *grid, uint32_t cell) {
+    Intersection *inter = &grid->cells[cell];
+
+    for (int d = 0; d < ROAD_COUNT; d++) {
+        uint32_t src;
+        if (!neighbor_of(grid, cell, (RoadDir)d, &src)) {
+            continue;
+        }
+        /* The neighbor in direction d sends toward OPPOSITE[d]. */
+        HandoffRing *ring = &grid->rings[src * ROAD_COUNT + OPPOSITE[d]];
+
+        HandoffItem item;
+        while (handoff_peek(ring, &item) &&
+               item.arrival_step <= inter->step_count) {
+            handoff_pop(ring);
+            if (!intersection_add_vehicle_interned(inter,
+                                                   (RoadDir)item.ingress_road,
+                                                   (RoadDir)item.heading,
+                                                   item.id)) {
+                grid->dropped[cell]++;
+            }
+        }
+    }
+}
+
+/*
+ * Departure sink for handoff mode: each vehicle is routed into its
+ * outgoing ring straight from the dequeue site (and mirrored into the
+ * cell's departure buffer for the grid_departed() API) instead of
+ * being buffered and rescanned after the step.
+ */
+typedef struct {
+    Grid    *grid;
+    uint32_t cell;
+} RouteCtx;
+
+static void route_departure(void *user, RoadDir road, Lane lane,
+                            const Vehicle *v) {
+    (void)road;
+    (void)lane;
+    RouteCtx     *ctx   = user;
+    Grid         *grid  = ctx->grid;
+    uint32_t      cell  = ctx->cell;
+    Intersection *inter = &grid->cells[cell];
+
+    grid->departed[cell][grid->departed_count[cell]++] = *v;
+
+    uint32_t dst;
+    if (v->end_road >= ROAD_NONE ||
+        !neighbor_of(grid, cell, (RoadDir)v->end_road, &dst)) {
+        grid->exited[cell]++;  /* boundary exit or no destination */
+        return;
+    }
+    HandoffItem item = {
+        .id           = v->id,
+        .ingress_road = OPPOSITE[v->end_road],
+        .heading      = v->end_road,
+        /* The callback fires before step_count advances; +1 matches
+         * the post-step counter the arrival check compares against. */
+        .arrival_step = inter->step_count + 1 + grid->travel_delay,
+    };
+    if (!handoff_push(&grid->rings[cell * ROAD_COUNT + v->end_road],
+                      &item)) {
+        grid->dropped[cell]++;
+    }
+}
+
+static void step_range(Grid *grid, uint32_t begin, uint32_t end) {
+    if (grid->rings == NULL) {
+        for (uint32_t i = begin; i < end; i++) {
+            intersection_step(&grid->cells[i], grid->departed[i],
+                              &grid->departed_count[i]);
+        }
+        return;
+    }
+    for (uint32_t i = begin; i < end; i++) {
+        drain_ingress(grid, i);
+        RouteCtx ctx = { grid, i };
+        grid->departed_count[i] = 0;
+        intersection_step_cb(&grid->cells[i], route_departure, &ctx);
+    }
+}
+
+static void *worker_main(void *arg) {
+    GridWorker *w    = arg;
+    Grid       *grid = w->grid;
+
+    for (;;) {
+        pthread_barrier_wait(&grid->start_barrier);
+        if (grid->shutting_down) {
+            return NULL;
+        }
+        step_range(grid, w->begin, w->end);
+        pthread_barrier_wait(&grid->done_barrier);
+    }
+}
+
+Grid *grid_create(uint16_t width, uint16_t height, int workers) {
+    if (width == 0 || height == 0) {
+        return NULL;
+    }
+
+    Grid *grid = calloc(1, sizeof(*grid));
+    if (grid == NULL) {
+        return NULL;
+    }
+    grid->width      = width;
+    grid->height     = height;
+    grid->cell_count = (uint32_t)width * height;
+
+    void *cells = NULL;
+    if (posix_memalign(&cells, 64,
+                       grid->cell_count * sizeof(Intersection)) != 0) {
+        free(grid);
+        return NULL;
+    }
+    grid->cells          = cells;
+    grid->departed       = malloc(grid->cell_count * sizeof(*grid->departed));
+    grid->departed_count = calloc(grid->cell_count, 1);
+    if (grid->departed == NULL || grid->departed_count == NULL) {
+        grid_destroy(grid);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < grid->cell_count; i++) {
+        intersection_init(&grid->cells[i]);
+    }
+
+    if (workers > GRID_MAX_WORKERS) {
+        workers = GRID_MAX_WORKERS;
+    }
+    if ((uint32_t)workers > grid->cell_count) {
+        workers = (int)grid->cell_count;
+    }
+    if (workers <= 1) {
+        grid->worker_count = 0; /* serial stepping */
+        return grid;
+    }
+
+    grid->worker_count = workers;
+    /* +1: grid_step()'s calling thread joins both barriers. */
+    pthread_barrier_init(&grid->start_barrier, NULL, (unsigned)workers + 1);
+    pthread_barrier_init(&grid->done_barrier, NULL, (unsigned)workers + 1);
+
+    uint32_t per = (grid->cell_count + (uint32_t)workers - 1) /
+                   (uint32_t)workers;
+    for (int w = 0; w < workers; w++) {
+        uint32_t begin = (uint32_t)w * per;
+        uint32_t end   = begin + per;
+        if (end > grid->cell_count) {
+            end = grid->cell_count;
+        }
+        grid->workers[w] = (GridWorker){ grid, begin, end };
+        pthread_create(&grid->threads[w], NULL, worker_main,
+                       &grid->workers[w]);
+    }
+    return grid;
+}
+
+void grid_destroy(Grid *grid) {
+    if (grid == NULL) {
+        return;
+    }
+    if (grid->worker_count > 0) {
+        grid->shutting_down = true;
+        pthread_barrier_wait(&grid->start_barrier);
+        for (int w = 0; w < grid->worker_count; w++) {
+            pthread_join(grid->threads[w], NULL);
+        }
+        pthread_barrier_destroy(&grid->start_barrier);
+        pthread_barrier_destroy(&grid->done_barrier);
+    }
+    free(grid->rings);
+    free(grid->exited);
+    free(grid->dropped);
+    free(grid->departed_count);
+    free(grid->departed);
+    free(grid->cells);
+    free(grid);
+}
+
+uint16_t grid_width(const Grid *grid)  { return grid->width; }
+uint16_t grid_height(const Grid *grid) { return grid->height; }
+
+Intersection *grid_at(Grid *grid, uint16_t x, uint16_t y) {
+    return &grid->cells[(uint32_t)y * grid->width + x];
+}
+
+void grid_step(Grid *grid) {
+    if (grid->worker_count == 0) {
+        step_range(grid, 0, grid->cell_count);
+        return;
+    }
+    pthread_barrier_wait(&grid->start_barrier);
+    /* workers run their ranges */
+    pthread_barrier_wait(&grid->done_barrier);
+}
+
+const Vehicle *grid_departed(const Grid *grid, uint16_t x, uint16_t y) {
+    return grid->departed[(uint32_t)y * grid->width + x];
+}
+
+uint8_t grid_departed_count(const Grid *grid, uint16_t x, uint16_t y) {
+    return grid->departed_count[(uint32_t)y * grid->width + x];
+}
+
+int grid_enable_handoff(Grid *grid, uint32_t travel_delay) {
+    if (grid->rings != NULL) {
+        return 0; /* already enabled */
+    }
+    size_t ring_count = (size_t)grid->cell_count * ROAD_COUNT;
+    grid->rings   = malloc(ring_count * sizeof(HandoffRing));
+    grid->exited  = calloc(grid->cell_count, sizeof(uint64_t));
+    grid->dropped = calloc(grid->cell_count, sizeof(uint64_t));
+    if (grid->rings == NULL || grid->exited == NULL ||
+        grid->dropped == NULL) {
+        free(grid->rings);
+        free(grid->exited);
+        free(grid->dropped);
+        grid->rings = NULL;
+        return 1;
+    }
+    for (size_t i = 0; i < ring_count; i++) {
+        handoff_init(&grid->rings[i]);
+    }
+    /* Delay 0 would let a racing consumer see a same-step departure. */
+    grid->travel_delay = travel_delay > 0 ? travel_delay : 1;
+    return 0;
+}
+
+uint64_t grid_exited_count(const Grid *grid) {
+    uint64_t total = 0;
+    if (grid->exited != NULL) {
+        for (uint32_t i = 0; i < grid->cell_count; i++) {
+            total += grid->exited[i];
+        }
+    }
+    return total;
+}
+
+uint64_t grid_dropped_count(const Grid *grid) {
+    uint64_t total = 0;
+    if (grid->dropped != NULL) {
+        for (uint32_t i = 0; i < grid->cell_count; i++) {
+            total += grid->dropped[i];
+        }
+    }
+    return total;
+}
@@ -57,14 +57,8 @@
  * GPIO lookup tables
  */
 
-/* Light outputs: [road][LightState] -> (port, pin) */
-static GPIO_TypeDef * const LIGHT_PORT[ROAD_COUNT][4] = {
-    [ROAD_NORTH] = { GPIOA, GPIOA, GPIOA, GPIOA },
-    [ROAD_SOUTH] = { GPIOA, GPIOA, GPIOA, GPIOA },
-    [ROAD_EAST]  = { GPIOB, GPIOB, GPIOB, GPIOB },
-    [ROAD_WEST]  = { GPIOB, GPIOB, GPIOB, GPIOB },
-};
-
+/* Light outputs: [road][LightState] -> pin (ports are per road pair;
+ * see LIGHT_BANK below) */
 static const uint16_t LIGHT_PIN[ROAD_COUNT][4] = {
     [ROAD_NORTH] = { GPIO_PIN_0, GPIO_PIN_1, GPIO_PIN_2, GPIO_PIN_3 },
     [ROAD_SOUTH] = { GPIO_PIN_4, GPIO_PIN_5, GPIO_PIN_6, GPIO_PIN_7 },
@@ -96,23 +90,48 @@ static bool stm32_sense_lane(RoadDir road, Lane lane) {
                             SENSE_PIN[road][lane]) == GPIO_PIN_SET;
 }
 
+/*
+ * Batched light output. Both light ports can be rewritten atomically
+ * through BSRR: the low half-word sets pins, the high half-word resets
+ * them, and set wins on overlap - all in one bus write with no
+ * read-modify-write. set_light() therefore only stages each road's
+ * pattern (reset all four of its pins, set the active one; disjoint
+ * pin masks per road, so staging is plain OR), and commit_lights()
+ * flushes both ports. A phase change costs two register writes instead
+ * of 16 HAL_GPIO_WritePin calls, and all lights on a port change in
+ * the same instant.
+ */
+
+static GPIO_TypeDef * const LIGHT_BANK_PORT[2] = { GPIOA, GPIOB };
+
+/* Which BSRR accumulator each road's pins belong to. */
+static const uint8_t LIGHT_BANK[ROAD_COUNT] = {
+    [ROAD_NORTH] = 0, [ROAD_SOUTH] = 0,
+    [ROAD_EAST]  = 1, [ROAD_WEST]  = 1,
+};
+
+static uint32_t pending_bsrr[2];
+
 static void stm32_set_light(RoadDir road, LightState state) {
-    /* De-assert all four outputs for this road, then assert the active one.
-     * This guarantees no two outputs are ever high at the same time,
-     * regardless of the order individual writes take effect. */
-    for (int s = 0; s < 4; s++) {
-        HAL_GPIO_WritePin(LIGHT_PORT[road][s],
-                          LIGHT_PIN[road][s],
-                          GPIO_PIN_RESET);
+    uint32_t road_pins = (uint32_t)(LIGHT_PIN[road][0] | LIGHT_PIN[road][1] |
+                                    LIGHT_PIN[road][2] | LIGHT_PIN[road][3]);
+    pending_bsrr[LIGHT_BANK[road]] |=
+        (road_pins << 16) | LIGHT_PIN[road][state];
+}
+
+static void stm32_commit_lights(void) {
+    for (int b = 0; b < 2; b++) {
+        if (pending_bsrr[b] != 0) {
+            LIGHT_BANK_PORT[b]->BSRR = pending_bsrr[b];
+            pending_bsrr[b] = 0;
+        }
     }
-    HAL_GPIO_WritePin(LIGHT_PORT[road][state],
-                      LIGHT_PIN[road][state],
-                      GPIO_PIN_SET);
 }
 
 static const EmbeddedHAL HAL_STM32 = {
-    .sense_lane = stm32_sense_lane,
-    .set_light  = stm32_set_light,
+    .sense_lane    = stm32_sense_lane,
+    .set_light     = stm32_set_light,
+    .commit_lights = stm32_commit_lights,
 };
 
 /*
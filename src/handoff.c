@@ -0,0 +1,43 @@
+#include "handoff.h"
+
+/*
+ * Classic SPSC ring: the producer only writes 'tail', the consumer only
+ * writes 'head'. Release on the writer side publishes the slot before
+ * the index moves; acquire on the reader side orders the index read
+ * before the slot read.
+ */
+
+#define RING_MASK (HANDOFF_RING_SIZE - 1u)
+
+void handoff_init(HandoffRing *ring) {
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+}
+
+bool handoff_push(HandoffRing *ring, const HandoffItem *item) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (tail - head >= HANDOFF_RING_SIZE - 1u) {
+        return false; /* full */
+    }
+    ring->buf[tail & RING_MASK] = *item;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool handoff_peek(const HandoffRing *ring, HandoffItem *out) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head == tail) {
+        return false; /* empty */
+    }
+    *out = ring->buf[head & RING_MASK];
+    return true;
+}
+
+void handoff_pop(HandoffRing *ring) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
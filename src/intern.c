@@ -0,0 +1,155 @@
+#include "intern.h"
+
+#if TSIM_NO_VEHICLE_IDS
+
+/*
+ * ID-less profile (embedded small-SRAM targets): ids are bare counters.
+ *
+ * The embedded path synthesizes ids only to throw them away - nothing
+ * ever resolves one back to a string - yet the real intern table below
+ * costs a heap (malloc for chunks and tables, on parts that often have
+ * none) and a printf-family call per arrival in the tick path. Here
+ * interning hands out the next counter without reading the string at
+ * all, vehicle_id_str() resolves every handle to "", and the core
+ * library becomes malloc- and stdio-free.
+ *
+ * Identity still works within a run (each arrival gets a fresh handle);
+ * what is lost is resolution to a printable id, which only the desktop
+ * protocol front-ends use.
+ */
+
+static uint32_t next_handle = 1;   /* 0 stays "empty", as below */
+
+uint32_t vehicle_id_intern(const char *s) {
+    (void)s;
+    return next_handle++;
+}
+
+const char *vehicle_id_str(uint32_t handle) {
+    (void)handle;
+    return "";
+}
+
+uint32_t vehicle_id_count(void) {
+    return next_handle;
+}
+
+#else /* full string interning */
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Open-addressing hash set over a chunked string arena.
+ *
+ * Strings are appended to fixed-size chunks that are never freed or
+ * reallocated, so the pointers handed out by vehicle_id_str() remain
+ * valid forever. The bucket table and the handle->string index grow by
+ * doubling.
+ */
+
+#define INTERN_CHUNK_SIZE   65536
+#define INTERN_INITIAL_CAP  256     /* buckets; must be a power of two */
+
+static const char **strs;        /* handle -> interned string        */
+static uint32_t     str_count;
+static uint32_t     str_cap;
+
+static uint32_t    *buckets;     /* handle + 1; 0 marks an empty slot */
+static uint32_t     bucket_cap;  /* power of two                      */
+
+static char        *chunk;       /* current arena chunk               */
+static size_t       chunk_used;
+
+static uint32_t hash_str(const char *s) {
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static const char *arena_copy(const char *s) {
+    size_t len = strlen(s) + 1;
+    if (chunk == NULL || chunk_used + len > INTERN_CHUNK_SIZE) {
+        /* Oversized IDs get a dedicated allocation via the same path. */
+        size_t size = len > INTERN_CHUNK_SIZE ? len : INTERN_CHUNK_SIZE;
+        chunk      = malloc(size);
+        chunk_used = 0;
+    }
+    char *dst = chunk + chunk_used;
+    memcpy(dst, s, len);
+    chunk_used += len;
+    return dst;
+}
+
+static void rehash(uint32_t new_cap) {
+    uint32_t *nb = calloc(new_cap, sizeof(*nb));
+    for (uint32_t i = 0; i < bucket_cap; i++) {
+        uint32_t entry = buckets[i];
+        if (entry == 0) {
+            continue;
+        }
+        uint32_t slot = hash_str(strs[entry - 1]) & (new_cap - 1);
+        while (nb[slot] != 0) {
+            slot = (slot + 1) & (new_cap - 1);
+        }
+        nb[slot] = entry;
+    }
+    free(buckets);
+    buckets    = nb;
+    bucket_cap = new_cap;
+}
+
+uint32_t vehicle_id_intern(const char *s) {
+    if (buckets == NULL) {
+        buckets    = calloc(INTERN_INITIAL_CAP, sizeof(*buckets));
+        bucket_cap = INTERN_INITIAL_CAP;
+        str_cap    = INTERN_INITIAL_CAP;
+        strs       = malloc(str_cap * sizeof(*strs));
+        /* Handle 0 is reserved for the empty string. */
+        strs[0]    = "";
+        str_count  = 1;
+    }
+    if (*s == '\0') {
+        return 0;
+    }
+
+    uint32_t slot = hash_str(s) & (bucket_cap - 1);
+    while (buckets[slot] != 0) {
+        uint32_t handle = buckets[slot] - 1;
+        if (strcmp(strs[handle], s) == 0) {
+            return handle;
+        }
+        slot = (slot + 1) & (bucket_cap - 1);
+    }
+
+    if (str_count == str_cap) {
+        str_cap *= 2;
+        strs = realloc(strs, str_cap * sizeof(*strs));
+    }
+    uint32_t handle = str_count++;
+    strs[handle]    = arena_copy(s);
+    buckets[slot]   = handle + 1;
+
+    /* Keep load factor below 3/4. */
+    if (str_count * 4 > bucket_cap * 3) {
+        rehash(bucket_cap * 2);
+    }
+    return handle;
+}
+
+const char *vehicle_id_str(uint32_t handle) {
+    if (handle >= str_count) {
+        return "";
+    }
+    return strs[handle];
+}
+
+uint32_t vehicle_id_count(void) {
+    return str_count;
+}
+
+#endif /* TSIM_NO_VEHICLE_IDS */
@@ -1,6 +1,10 @@
 #include "intersection.h"
 #include "controller.h"
+#include "countvec.h"
+#include "intern.h"
 #include "road.h"
+#include "stepstats.h"
+#include "topology.h"
 #include "traffic_light.h"
 #include <string.h>
 
@@ -8,6 +12,29 @@
  * Internal helpers
  * ---------------------------------------------------------------------- */
 
+/*
+ * Recompute one lane's cached score contribution and fold the delta into
+ * its phase's cached total. Called whenever the lane's front vehicle or
+ * count may have changed.
+ */
+static void refresh_lane_score(Intersection *inter, RoadDir road, Lane lane) {
+    uint32_t contribution = 0;
+    uint8_t  count = road_lane_count(&inter->roads[road], lane);
+
+    if (count > 0) {
+        Vehicle front;
+        road_peek_lane(&inter->roads[road], lane, &front);
+        uint32_t wait = inter->step_count - front.enqueue_step;
+        contribution  = (uint32_t)count * (1u + wait);
+    }
+
+    Phase phase = controller_phase_for_lane(road, lane);
+    inter->phase_scores[phase]     -= inter->lane_scores[road][lane];
+    inter->phase_scores[phase]     += contribution;
+    inter->lane_scores[road][lane]  = contribution;
+    inter->lane_counts[road * LANES_PER_ROAD + lane] = count;
+}
+
 /*
  * Apply a phase decision: activate the relevant lights and update state.
  * Called both at init time and whenever phase_steps_remaining hits 0.
@@ -38,10 +65,53 @@ void intersection_init(Intersection *inter) {
         road_init(&inter->roads[i]);
         traffic_light_init(&inter->lights[i]);
     }
+#if TSIM_SPILL_POOL
+    spill_pool_init(&inter->spill_pool);
+    for (int r = 0; r < ROAD_COUNT; r++) {
+        for (int l = 0; l < LANES_PER_ROAD; l++) {
+            queue_attach_spill(&inter->roads[r].lanes[l], &inter->spill_pool);
+        }
+    }
+#endif
+    inter->params = (ControllerParams){
+        .min_green_steps = MIN_GREEN_STEPS,
+        .max_green_steps = MAX_GREEN_STEPS,
+        .yellow_steps    = YELLOW_STEPS,
+    };
     inter->current_phase         = PHASE_NS;
     inter->phase_steps_remaining = 0;
     inter->in_yellow_transition  = false;
     inter->step_count            = 0;
+    memset(inter->wait_hists, 0, sizeof(inter->wait_hists));
+#if TSIM_STEP_TIMING
+    memset(&inter->step_stats, 0, sizeof(inter->step_stats));
+#endif
+    intersection_rebuild_scores(inter);
+}
+
+void intersection_set_params(Intersection *inter,
+                             const ControllerParams *params) {
+    inter->params = *params;
+    if (inter->params.min_green_steps == 0) {
+        inter->params.min_green_steps = 1;
+    }
+    if (inter->params.max_green_steps < inter->params.min_green_steps) {
+        inter->params.max_green_steps = inter->params.min_green_steps;
+    }
+    for (int i = 0; i < ROAD_COUNT; i++) {
+        inter->lights[i].yellow_steps = inter->params.yellow_steps;
+    }
+}
+
+void intersection_rebuild_scores(Intersection *inter) {
+    memset(inter->lane_scores, 0, sizeof(inter->lane_scores));
+    memset(inter->phase_scores, 0, sizeof(inter->phase_scores));
+    memset(inter->lane_counts, 0, sizeof(inter->lane_counts));
+    for (int r = 0; r < ROAD_COUNT; r++) {
+        for (int l = 0; l < LANES_PER_ROAD; l++) {
+            refresh_lane_score(inter, (RoadDir)r, (Lane)l);
+        }
+    }
 }
 
 bool intersection_add_vehicle(Intersection *inter,
@@ -52,15 +122,31 @@ bool intersection_add_vehicle(Intersection *inter,
     if (mv == MOVE_INVALID) {
         return false;
     }
+    return intersection_add_vehicle_interned(inter, start, end,
+                                             vehicle_id_intern(id));
+}
+
+bool intersection_add_vehicle_interned(Intersection *inter,
+                                       RoadDir       start,
+                                       RoadDir       end,
+                                       uint32_t      id) {
+    MovementType mv = movement_type(start, end);
+    if (mv == MOVE_INVALID) {
+        return false;
+    }
 
     Vehicle v;
     memset(&v, 0, sizeof(v));
-    strncpy(v.id, id, MAX_VEHICLE_ID_LEN - 1);
+    v.id           = id;
     v.end_road     = end;
     v.movement     = mv;
     v.enqueue_step = inter->step_count;
 
-    return road_enqueue(&inter->roads[start], &v);
+    if (!road_enqueue(&inter->roads[start], &v)) {
+        return false;
+    }
+    refresh_lane_score(inter, start, lane_for_movement(mv));
+    return true;
 }
 
 bool intersection_add_vehicle_by_lane(Intersection *inter,
@@ -83,26 +169,56 @@ bool intersection_add_vehicle_by_lane(Intersection *inter,
 
     Vehicle v;
     memset(&v, 0, sizeof(v));
-    strncpy(v.id, id, MAX_VEHICLE_ID_LEN - 1);
+    v.id           = vehicle_id_intern(id);
     v.end_road     = ROAD_NONE;
     v.movement     = lane_to_movement[lane];
     v.enqueue_step = inter->step_count;
 
-    return queue_enqueue(&inter->roads[road].lanes[lane], &v);
+    if (!queue_enqueue(&inter->roads[road].lanes[lane], &v)) {
+        return false;
+    }
+    refresh_lane_score(inter, road, lane);
+    return true;
 }
 
-void intersection_step(Intersection *inter,
-                       Vehicle       departed[MAX_DEPARTURES_PER_STEP],
-                       uint8_t      *count) {
-    *count = 0;
+void intersection_step_cb(Intersection *inter, DepartureFn on_departure,
+                          void *user) {
+    STEP_TIMER_DECL;
 
     /* 1. If current phase is exhausted, pick the next one. */
+    STEP_TIMER_START();
     if (inter->phase_steps_remaining == 0) {
         PhaseDecision decision = controller_next_phase(inter);
         apply_phase(inter, decision);
     }
+    STEP_TIMER_STOP(inter, STEP_STAGE_CONTROLLER);
 
     /* 2. Dequeue the front vehicle from each active green lane. */
+    STEP_TIMER_START();
+#if TSIM_SPECIALIZE_TOPOLOGY
+    /* Unrolled via topology.h: constant road/lane indices, no table
+     * walk, no is_arrow branch. The green check stays - a yellow
+     * transition must not release vehicles. */
+    #define DEQUEUE_ONE(road_, lane_)                                       \
+        if (traffic_light_is_green(&inter->lights[road_])) {                \
+            Vehicle v;                                                      \
+            if (road_dequeue_lane(&inter->roads[road_], lane_, &v)) {       \
+                waithist_record(&inter->wait_hists[road_],                  \
+                                inter->step_count - v.enqueue_step);        \
+                refresh_lane_score(inter, road_, lane_);                    \
+                on_departure(user, road_, lane_, &v);                       \
+            }                                                               \
+        }
+
+    switch (inter->current_phase) {
+        case PHASE_NS:       TOPOLOGY_NS_LANES(DEQUEUE_ONE)       break;
+        case PHASE_EW:       TOPOLOGY_EW_LANES(DEQUEUE_ONE)       break;
+        case PHASE_NS_ARROW: TOPOLOGY_NS_ARROW_LANES(DEQUEUE_ONE) break;
+        case PHASE_EW_ARROW: TOPOLOGY_EW_ARROW_LANES(DEQUEUE_ONE) break;
+        default: break;
+    }
+    #undef DEQUEUE_ONE
+#else
     const PhaseInfo *info = &PHASE_INFO[inter->current_phase];
     for (int r = 0; r < info->road_count; r++) {
         RoadDir dir = info->roads[r];
@@ -113,28 +229,297 @@ void intersection_step(Intersection *inter,
         Vehicle v;
         if (info->is_arrow) {
             if (road_dequeue_lane(&inter->roads[dir], LANE_LEFT, &v)) {
-                departed[(*count)++] = v;
+                waithist_record(&inter->wait_hists[dir],
+                                inter->step_count - v.enqueue_step);
+                refresh_lane_score(inter, dir, LANE_LEFT);
+                on_departure(user, dir, LANE_LEFT, &v);
             }
         } else {
             if (road_dequeue_lane(&inter->roads[dir], LANE_STRAIGHT, &v)) {
-                departed[(*count)++] = v;
+                waithist_record(&inter->wait_hists[dir],
+                                inter->step_count - v.enqueue_step);
+                refresh_lane_score(inter, dir, LANE_STRAIGHT);
+                on_departure(user, dir, LANE_STRAIGHT, &v);
             }
             if (road_dequeue_lane(&inter->roads[dir], LANE_RIGHT, &v)) {
-                departed[(*count)++] = v;
+                waithist_record(&inter->wait_hists[dir],
+                                inter->step_count - v.enqueue_step);
+                refresh_lane_score(inter, dir, LANE_RIGHT);
+                on_departure(user, dir, LANE_RIGHT, &v);
             }
         }
     }
+#endif /* TSIM_SPECIALIZE_TOPOLOGY */
+    STEP_TIMER_STOP(inter, STEP_STAGE_DEQUEUE);
 
     /* 3. Tick all traffic lights. */
+    STEP_TIMER_START();
     for (int i = 0; i < ROAD_COUNT; i++) {
         traffic_light_tick(&inter->lights[i]);
     }
+    STEP_TIMER_STOP(inter, STEP_STAGE_LIGHTS);
 
     /* 4. Advance counters. */
+    STEP_TIMER_START();
     if (inter->phase_steps_remaining > 0) {
         inter->phase_steps_remaining--;
     }
     inter->step_count++;
+
+    /* 5. Age the cached scores: every non-empty lane's front vehicle has
+     *    now waited one step longer, which raises that lane's score by
+     *    exactly its vehicle count. */
+    for (int r = 0; r < ROAD_COUNT; r++) {
+        for (int l = 0; l < LANES_PER_ROAD; l++) {
+            uint8_t c = inter->roads[r].lanes[l].count;
+            if (c > 0) {
+                inter->lane_scores[r][l] += c;
+                inter->phase_scores[controller_phase_for_lane((RoadDir)r,
+                                                              (Lane)l)] += c;
+            }
+        }
+    }
+    STEP_TIMER_STOP(inter, STEP_STAGE_SCORES);
+}
+
+/* Array adapter: collect departures for intersection_step() callers. */
+typedef struct {
+    Vehicle *departed;
+    uint8_t *count;
+} CollectCtx;
+
+static void collect_departure(void *user, RoadDir road, Lane lane,
+                              const Vehicle *v) {
+    (void)road;
+    (void)lane;
+    CollectCtx *out = user;
+    out->departed[(*out->count)++] = *v;
+}
+
+void intersection_step(Intersection *inter,
+                       Vehicle       departed[MAX_DEPARTURES_PER_STEP],
+                       uint8_t      *count) {
+    *count = 0;
+    CollectCtx out = { departed, count };
+    intersection_step_cb(inter, collect_departure, &out);
+}
+
+uint32_t intersection_fast_forward(Intersection *inter, uint32_t max_steps) {
+    if (countvec_sum(inter->lane_counts) != 0) {
+        return 0;
+    }
+
+    /*
+     * With every lane empty, the controller keeps the current phase at
+     * each boundary (ties go to the incumbent) with min_green duration,
+     * so the lights fall into a cycle whose period is min_green_steps.
+     * Rather than proving exactly when the cycle is entered - a light
+     * may still be draining a yellow from the last loaded phase - walk
+     * normally to a phase boundary, record the light/phase sub-state,
+     * run one period, and skip the remaining whole periods only if the
+     * sub-state came back identical. Verification makes the skip safe
+     * against any future controller change; if the state fails to
+     * repeat we just keep stepping, which is always correct.
+     */
+    Vehicle  departed[MAX_DEPARTURES_PER_STEP];
+    uint8_t  count;
+    uint32_t done   = 0;
+    uint32_t period = inter->params.min_green_steps > 0
+                    ? inter->params.min_green_steps : 1;
+
+    while (done < max_steps) {
+        if (inter->phase_steps_remaining != 0 ||
+            max_steps - done < 2 * period) {
+            /* Mid-phase, or too few steps left to verify plus skip. */
+            intersection_step(inter, departed, &count);
+            done++;
+            continue;
+        }
+
+        TrafficLight lights[ROAD_COUNT];
+        memcpy(lights, inter->lights, sizeof(lights));
+        Phase   phase  = inter->current_phase;
+        uint8_t rem    = inter->phase_steps_remaining;
+        bool    yellow = inter->in_yellow_transition;
+
+        for (uint32_t i = 0; i < period; i++) {
+            intersection_step(inter, departed, &count);
+            done++;
+        }
+
+        if (memcmp(lights, inter->lights, sizeof(lights)) == 0 &&
+            phase == inter->current_phase &&
+            rem == inter->phase_steps_remaining &&
+            yellow == inter->in_yellow_transition) {
+            uint32_t periods = (max_steps - done) / period;
+            inter->step_count += periods * period;
+            done += periods * period;
+        }
+    }
+    return done;
+}
+
+/* -------------------------------------------------------------------------
+ * Snapshot / restore
+ * ---------------------------------------------------------------------- */
+
+/*
+ * Blob layout: SnapshotHeader, the raw Intersection bytes, then the ID
+ * strings of every queued vehicle (NUL-terminated, in road/lane/FIFO
+ * order). Interned handles are process-local, so the strings section is
+ * what lets a blob restore correctly in a different process - the use
+ * case that motivates snapshots in the first place. The header pins
+ * down the format version and sizeof(Intersection), so a blob from a
+ * build with a different struct layout is rejected instead of silently
+ * misread.
+ */
+typedef struct {
+    char     magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t state_size;
+    uint32_t strings_size;
+} SnapshotHeader;
+
+#define SNAPSHOT_MAGIC   "TSNP"
+#define SNAPSHOT_VERSION 1
+
+/* Visit every queued ring slot in deterministic (road, lane, FIFO)
+ * order. The ring is structure-of-arrays, so the body addresses the
+ * field it needs as q-><array>[slot] rather than through a Vehicle*. */
+#define FOR_EACH_QUEUED(inter, q, slot)                                     \
+    for (int _r = 0; _r < ROAD_COUNT; _r++)                                 \
+        for (int _l = 0; _l < LANES_PER_ROAD; _l++)                         \
+            for (VehicleQueue *q = &(inter)->roads[_r].lanes[_l];           \
+                 q != NULL; q = NULL)                                       \
+                for (uint8_t _i = 0; _i < q->count; _i++)                   \
+                    for (uint8_t slot = (uint8_t)((q->head + _i) %          \
+                                            MAX_VEHICLES_PER_LANE), _go = 1;\
+                         _go; _go = 0)
+
+/*
+ * Companion walk for spilled vehicles: visited after every ring in the
+ * same (road, lane, FIFO) order. Expands to a no-op loop in builds
+ * without the spill pool so call sites stay unconditional.
+ */
+#if TSIM_SPILL_POOL
+#define FOR_EACH_SPILLED(inter, v)                                          \
+    for (int _r = 0; _r < ROAD_COUNT; _r++)                                 \
+        for (int _l = 0; _l < LANES_PER_ROAD; _l++)                         \
+            for (uint8_t _n = (inter)->roads[_r].lanes[_l].spill_head;      \
+                 _n != 0; _n = (inter)->spill_pool.nodes[_n - 1].next)      \
+                for (Vehicle *v = &(inter)->spill_pool.nodes[_n - 1].vehicle;\
+                     v != NULL; v = NULL)
+#else
+#define FOR_EACH_SPILLED(inter, v)                                          \
+    for (Vehicle *v = NULL; v != NULL;)
+#endif
+
+static uint32_t snapshot_strings_size(const Intersection *inter) {
+    uint32_t size = 0;
+    FOR_EACH_QUEUED((Intersection *)inter, q, slot) {
+        size += (uint32_t)strlen(vehicle_id_str(q->ids[slot])) + 1;
+    }
+    FOR_EACH_SPILLED((Intersection *)inter, v) {
+        size += (uint32_t)strlen(vehicle_id_str(v->id)) + 1;
+    }
+    return size;
+}
+
+size_t intersection_snapshot_size(const Intersection *inter) {
+    return sizeof(SnapshotHeader) + sizeof(Intersection) +
+           snapshot_strings_size(inter);
+}
+
+size_t intersection_save(const Intersection *inter, void *buf, size_t cap) {
+    size_t total = intersection_snapshot_size(inter);
+    if (cap < total) {
+        return 0;
+    }
+
+    SnapshotHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, SNAPSHOT_MAGIC, 4);
+    hdr.version      = SNAPSHOT_VERSION;
+    hdr.state_size   = (uint32_t)sizeof(Intersection);
+    hdr.strings_size = snapshot_strings_size(inter);
+
+    char *p = buf;
+    memcpy(p, &hdr, sizeof(hdr));
+    p += sizeof(hdr);
+    memcpy(p, inter, sizeof(Intersection));
+    p += sizeof(Intersection);
+
+    FOR_EACH_QUEUED((Intersection *)inter, q, slot) {
+        const char *id  = vehicle_id_str(q->ids[slot]);
+        size_t      len = strlen(id) + 1;
+        memcpy(p, id, len);
+        p += len;
+    }
+    FOR_EACH_SPILLED((Intersection *)inter, v) {
+        const char *id  = vehicle_id_str(v->id);
+        size_t      len = strlen(id) + 1;
+        memcpy(p, id, len);
+        p += len;
+    }
+    return total;
+}
+
+bool intersection_load(Intersection *inter, const void *buf, size_t size) {
+    if (size < sizeof(SnapshotHeader)) {
+        return false;
+    }
+
+    SnapshotHeader hdr;
+    memcpy(&hdr, buf, sizeof(hdr));
+    if (memcmp(hdr.magic, SNAPSHOT_MAGIC, 4) != 0 ||
+        hdr.version != SNAPSHOT_VERSION ||
+        hdr.state_size != sizeof(Intersection) ||
+        size != sizeof(SnapshotHeader) + sizeof(Intersection) +
+                hdr.strings_size) {
+        return false;
+    }
+
+    /* Build the restored state in a scratch copy so *inter stays
+     * untouched if the strings section turns out to be truncated. */
+    static Intersection tmp;
+    memcpy(&tmp, (const char *)buf + sizeof(hdr), sizeof(Intersection));
+
+    /* Re-intern the saved ID strings into this process and patch the
+     * queued vehicles' handles, in the same deterministic order they
+     * were written. */
+    const char *p   = (const char *)buf + sizeof(hdr) + sizeof(Intersection);
+    const char *end = p + hdr.strings_size;
+    FOR_EACH_QUEUED(&tmp, q, slot) {
+        if (p >= end || memchr(p, '\0', (size_t)(end - p)) == NULL) {
+            return false; /* truncated strings section */
+        }
+        q->ids[slot] = vehicle_id_intern(p);
+        p += strlen(p) + 1;
+    }
+    FOR_EACH_SPILLED(&tmp, v) {
+        if (p >= end || memchr(p, '\0', (size_t)(end - p)) == NULL) {
+            return false;
+        }
+        v->id = vehicle_id_intern(p);
+        p += strlen(p) + 1;
+    }
+
+    *inter = tmp;
+#if TSIM_SPILL_POOL
+    /* The blob carries another process's pool pointers; repoint every
+     * lane at this intersection's own slab. */
+    for (int r = 0; r < ROAD_COUNT; r++) {
+        for (int l = 0; l < LANES_PER_ROAD; l++) {
+            queue_attach_spill(&inter->roads[r].lanes[l],
+                               &inter->spill_pool);
+        }
+    }
+#endif
+    /* The blob carries the cached scores, but rebuilding costs little
+     * and keeps restore safe even if a future save path omits them. */
+    intersection_rebuild_scores(inter);
+    return true;
 }
 
 LightState intersection_light_state(const Intersection *inter, RoadDir road) {
@@ -142,9 +527,5 @@ LightState intersection_light_state(const Intersection *inter, RoadDir road) {
 }
 
 uint8_t intersection_total_waiting(const Intersection *inter) {
-    uint8_t total = 0;
-    for (int i = 0; i < ROAD_COUNT; i++) {
-        total += road_total_count(&inter->roads[i]);
-    }
-    return total;
+    return (uint8_t)countvec_sum(inter->lane_counts);
 }
@@ -0,0 +1,165 @@
+#include "journal.h"
+#include "intersection.h"
+#include <string.h>
+#include <unistd.h>
+
+static int write_header(Journal *j) {
+    JournalHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, JOURNAL_MAGIC, 4);
+    hdr.version     = JOURNAL_VERSION;
+    hdr.record_size = sizeof(JournalRecord);
+    if (fwrite(&hdr, sizeof(hdr), 1, j->f) != 1) {
+        return 1;
+    }
+    fflush(j->f);
+    return 0;
+}
+
+int journal_open(Journal *j, const char *path, bool truncate) {
+    memset(j, 0, sizeof(*j));
+
+    /* "ab" gives O_APPEND: every record lands atomically at the current
+     * end of file even if another writer (or a recovery race) holds the
+     * file open. */
+    j->f = fopen(path, truncate ? "wb" : "ab");
+    if (j->f == NULL) {
+        fprintf(stderr, "journal: cannot write %s\n", path);
+        return 1;
+    }
+
+    fseek(j->f, 0, SEEK_END);   /* "ab" leaves the position unspecified */
+    long pos = ftell(j->f);
+    if (truncate || pos == 0) {
+        if (write_header(j) != 0) {
+            fprintf(stderr, "journal: cannot write %s\n", path);
+            fclose(j->f);
+            j->f = NULL;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int64_t journal_replay(const char *path, Intersection *inter) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "journal: cannot read %s\n", path);
+        return -1;
+    }
+
+    JournalHeader hdr;
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        memcmp(hdr.magic, JOURNAL_MAGIC, 4) != 0 ||
+        hdr.version != JOURNAL_VERSION ||
+        hdr.record_size != sizeof(JournalRecord)) {
+        fprintf(stderr, "journal: %s is not a journal (bad header)\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    int64_t applied = 0;
+    JournalRecord rec;
+    /* A short read here is the torn tail of a crashed append - stop,
+     * don't fail; everything before it is intact by construction. */
+    while (fread(&rec, sizeof(rec), 1, f) == 1) {
+        if (rec.opcode == JOURNAL_OP_ADD_VEHICLE) {
+            rec.id[MAX_VEHICLE_ID_LEN - 1] = '\0';
+            intersection_add_vehicle(inter, (RoadDir)rec.start_road,
+                                     (RoadDir)rec.end_road, rec.id);
+        } else if (rec.opcode == JOURNAL_OP_STEP) {
+            uint32_t n = 0;
+            while (n < rec.arg) {
+                uint32_t skipped =
+                    intersection_fast_forward(inter, rec.arg - n);
+                if (skipped > 0) {
+                    n += skipped;
+                    continue;
+                }
+                Vehicle departed[MAX_DEPARTURES_PER_STEP];
+                uint8_t count;
+                intersection_step(inter, departed, &count);
+                n++;
+            }
+        } else {
+            break; /* corrupt record: treat like a torn tail */
+        }
+        applied++;
+    }
+
+    /* Cut off a torn or corrupt tail, otherwise records appended after
+     * recovery would sit misaligned behind it and be lost to the next
+     * replay. */
+    long expected = (long)sizeof(JournalHeader) +
+                    (long)applied * (long)sizeof(JournalRecord);
+    fseek(f, 0, SEEK_END);
+    if (ftell(f) != expected) {
+        if (truncate(path, expected) != 0) {
+            fprintf(stderr, "journal: cannot drop torn tail of %s\n", path);
+        }
+    }
+
+    fclose(f);
+    return applied;
+}
+
+static void append(Journal *j, const JournalRecord *rec) {
+    if (j->f == NULL) {
+        return;
+    }
+    fwrite(rec, sizeof(*rec), 1, j->f);
+    if (++j->unsynced >= JOURNAL_SYNC_INTERVAL) {
+        journal_sync(j);
+    }
+}
+
+void journal_add_vehicle(Journal *j, RoadDir start, RoadDir end,
+                         const char *id) {
+    JournalRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.opcode     = JOURNAL_OP_ADD_VEHICLE;
+    rec.start_road = (uint8_t)start;
+    rec.end_road   = (uint8_t)end;
+    strncpy(rec.id, id, MAX_VEHICLE_ID_LEN - 1);
+    append(j, &rec);
+}
+
+void journal_step(Journal *j, uint32_t count) {
+    JournalRecord rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.opcode = JOURNAL_OP_STEP;
+    rec.arg    = count;
+    append(j, &rec);
+}
+
+void journal_sync(Journal *j) {
+    if (j->f == NULL || j->unsynced == 0) {
+        return;
+    }
+    fflush(j->f);
+    fsync(fileno(j->f));
+    j->unsynced = 0;
+}
+
+void journal_reset(Journal *j) {
+    if (j->f == NULL) {
+        return;
+    }
+    /* freopen would lose the path; rewind-and-truncate keeps the same
+     * descriptor and the O_APPEND flag. */
+    fflush(j->f);
+    if (ftruncate(fileno(j->f), 0) == 0) {
+        rewind(j->f);
+        write_header(j);
+    }
+    j->unsynced = 0;
+}
+
+void journal_close(Journal *j) {
+    if (j->f == NULL) {
+        return;
+    }
+    journal_sync(j);
+    fclose(j->f);
+    j->f = NULL;
+}
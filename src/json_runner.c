@@ -0,0 +1,280 @@
+#include "json_runner.h"
+#include "intern.h"
+#include "intersection.h"
+#include "road.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------
+ * Minimal JSON scanner
+ *
+ * Just enough JSON for the scenario schema: objects, arrays, strings,
+ * and skipping over anything else. No allocation during parsing - string
+ * values are copied into fixed caller buffers.
+ * ---------------------------------------------------------------------- */
+
+typedef struct {
+    const char *p;    /* cursor */
+    const char *end;
+} JsonCursor;
+
+static void js_skip_ws(JsonCursor *c) {
+    while (c->p < c->end &&
+           (*c->p == ' ' || *c->p == '\t' || *c->p == '\n' || *c->p == '\r')) {
+        c->p++;
+    }
+}
+
+/* Peek the next non-whitespace character, or '\0' at end of input. */
+static char js_peek(JsonCursor *c) {
+    js_skip_ws(c);
+    return c->p < c->end ? *c->p : '\0';
+}
+
+/* Consume 'ch' if it is next; returns false otherwise. */
+static bool js_accept(JsonCursor *c, char ch) {
+    if (js_peek(c) != ch) {
+        return false;
+    }
+    c->p++;
+    return true;
+}
+
+/*
+ * Parse a quoted string into out[cap]. Longer values are truncated (the
+ * cursor still advances past the whole string). Only the escapes that can
+ * appear in scenario files (\" and \\) are unescaped.
+ */
+static bool js_parse_string(JsonCursor *c, char *out, size_t cap) {
+    if (!js_accept(c, '"')) {
+        return false;
+    }
+    size_t n = 0;
+    while (c->p < c->end && *c->p != '"') {
+        char ch = *c->p++;
+        if (ch == '\\' && c->p < c->end) {
+            ch = *c->p++;
+        }
+        if (n + 1 < cap) {
+            out[n++] = ch;
+        }
+    }
+    if (cap > 0) {
+        out[n] = '\0';
+    }
+    return js_accept(c, '"');
+}
+
+/* Skip one value of any type (used for keys we don't care about). */
+static bool js_skip_value(JsonCursor *c) {
+    char ch = js_peek(c);
+    if (ch == '"') {
+        char discard[2];
+        return js_parse_string(c, discard, sizeof(discard));
+    }
+    if (ch == '{' || ch == '[') {
+        char close = (ch == '{') ? '}' : ']';
+        c->p++;
+        if (js_accept(c, close)) {
+            return true;
+        }
+        do {
+            if (ch == '{') {
+                char key[2];
+                if (!js_parse_string(c, key, sizeof(key)) ||
+                    !js_accept(c, ':')) {
+                    return false;
+                }
+            }
+            if (!js_skip_value(c)) {
+                return false;
+            }
+        } while (js_accept(c, ','));
+        return js_accept(c, close);
+    }
+    /* Number / true / false / null: consume the bare token. */
+    js_skip_ws(c);
+    const char *start = c->p;
+    while (c->p < c->end && *c->p != ',' && *c->p != '}' && *c->p != ']' &&
+           *c->p != ' ' && *c->p != '\t' && *c->p != '\n' && *c->p != '\r') {
+        c->p++;
+    }
+    return c->p > start;
+}
+
+/* -------------------------------------------------------------------------
+ * Scenario execution
+ * ---------------------------------------------------------------------- */
+
+static bool parse_command_object(JsonCursor *c, ScenarioCommand *cmd) {
+    memset(cmd, 0, sizeof(*cmd));
+    if (!js_accept(c, '{')) {
+        return false;
+    }
+    if (js_accept(c, '}')) {
+        return true;
+    }
+    do {
+        char key[16];
+        if (!js_parse_string(c, key, sizeof(key)) || !js_accept(c, ':')) {
+            return false;
+        }
+        if (strcmp(key, "type") == 0) {
+            if (!js_parse_string(c, cmd->type, sizeof(cmd->type))) return false;
+        } else if (strcmp(key, "vehicleId") == 0) {
+            if (!js_parse_string(c, cmd->vehicle_id,
+                                 sizeof(cmd->vehicle_id))) return false;
+        } else if (strcmp(key, "startRoad") == 0) {
+            if (!js_parse_string(c, cmd->start_road,
+                                 sizeof(cmd->start_road))) return false;
+        } else if (strcmp(key, "endRoad") == 0) {
+            if (!js_parse_string(c, cmd->end_road,
+                                 sizeof(cmd->end_road))) return false;
+        } else {
+            if (!js_skip_value(c)) return false;
+        }
+    } while (js_accept(c, ','));
+    return js_accept(c, '}');
+}
+
+/*
+ * Write one step's departures in bridge.py's indent=2 layout:
+ *
+ *     {
+ *       "leftVehicles": [
+ *         "vehicle1"
+ *       ]
+ *     }
+ */
+static void write_step_status(FILE *out, const Vehicle *departed,
+                              uint8_t count, bool first) {
+    if (!first) {
+        fputs(",", out);
+    }
+    fputs("\n    {\n      \"leftVehicles\": [", out);
+    for (uint8_t i = 0; i < count; i++) {
+        fprintf(out, "%s\n        \"%s\"", i > 0 ? "," : "", vehicle_id_str(departed[i].id));
+    }
+    if (count > 0) {
+        fputs("\n      ]\n    }", out);
+    } else {
+        fputs("]\n    }", out);
+    }
+}
+
+static char *read_whole_file(const char *path, long *size_out) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = malloc((size_t)size + 1);
+    if (buf == NULL || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        free(buf);
+        fclose(f);
+        return NULL;
+    }
+    buf[size] = '\0';
+    fclose(f);
+    *size_out = size;
+    return buf;
+}
+
+int json_for_each_command(const char *input_path, scenario_command_fn fn,
+                          void *user) {
+    long size = 0;
+    char *text = read_whole_file(input_path, &size);
+    if (text == NULL) {
+        fprintf(stderr, "json: cannot read %s\n", input_path);
+        return 1;
+    }
+
+    JsonCursor c = { text, text + size };
+    bool ok = false;
+
+    /* Top-level object: walk "commands", skip everything else. */
+    if (js_accept(&c, '{') && !js_accept(&c, '}')) {
+        do {
+            char key[16];
+            if (!js_parse_string(&c, key, sizeof(key)) ||
+                !js_accept(&c, ':')) {
+                goto done;
+            }
+            if (strcmp(key, "commands") != 0) {
+                if (!js_skip_value(&c)) goto done;
+                continue;
+            }
+            if (!js_accept(&c, '[')) goto done;
+            if (js_accept(&c, ']')) continue;
+            do {
+                ScenarioCommand cmd;
+                if (!parse_command_object(&c, &cmd)) goto done;
+                fn(&cmd, user);
+            } while (js_accept(&c, ','));
+            if (!js_accept(&c, ']')) goto done;
+        } while (js_accept(&c, ','));
+        if (!js_accept(&c, '}')) goto done;
+    }
+    ok = true;
+
+done:;
+    long offset = (long)(c.p - text);
+    free(text);
+
+    if (!ok) {
+        fprintf(stderr, "json: malformed scenario in %s (offset %ld)\n",
+                input_path, offset);
+        return 1;
+    }
+    return 0;
+}
+
+/* Execution context threaded through json_for_each_command(). */
+typedef struct {
+    Intersection inter;
+    FILE        *out;
+    bool         first_status;
+} RunContext;
+
+static void run_command(const ScenarioCommand *cmd, void *user) {
+    RunContext *ctx = user;
+
+    if (strcmp(cmd->type, "addVehicle") == 0) {
+        intersection_add_vehicle(&ctx->inter,
+                                 road_from_name(cmd->start_road),
+                                 road_from_name(cmd->end_road),
+                                 cmd->vehicle_id);
+    } else if (strcmp(cmd->type, "step") == 0) {
+        Vehicle departed[MAX_DEPARTURES_PER_STEP];
+        uint8_t count = 0;
+        intersection_step(&ctx->inter, departed, &count);
+        write_step_status(ctx->out, departed, count, ctx->first_status);
+        ctx->first_status = false;
+    }
+}
+
+int json_run_file(const char *input_path, const char *output_path) {
+    FILE *out = fopen(output_path, "w");
+    if (out == NULL) {
+        fprintf(stderr, "json: cannot write %s\n", output_path);
+        return 1;
+    }
+
+    static RunContext ctx; /* Intersection is large; keep it off the stack */
+    intersection_init(&ctx.inter);
+    ctx.out          = out;
+    ctx.first_status = true;
+
+    fputs("{\n  \"stepStatuses\": [", out);
+    int rc = json_for_each_command(input_path, run_command, &ctx);
+    if (ctx.first_status) {
+        fputs("]\n}\n", out);          /* no steps at all */
+    } else {
+        fputs("\n  ]\n}\n", out);
+    }
+    fclose(out);
+    return rc;
+}
@@ -1,21 +1,153 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "generate.h"
+#include "intern.h"
 #include "intersection.h"
+#include "journal.h"
+#include "json_runner.h"
 #include "road.h"
+#include "server.h"
+#include "stepstats.h"
+#include "sweep.h"
+#include "trace.h"
 
-static RoadDir parse_road(const char *s) {
-    if (strcmp(s, "north") == 0) return ROAD_NORTH;
-    if (strcmp(s, "south") == 0) return ROAD_SOUTH;
-    if (strcmp(s, "east")  == 0) return ROAD_EAST;
-    if (strcmp(s, "west")  == 0) return ROAD_WEST;
-    return ROAD_NONE;
+/* Departure sink for the line protocol: ids go straight from the
+ * dequeue site into stdio, no intermediate Vehicle array. */
+static void print_departure(void *user, RoadDir road, Lane lane,
+                            const Vehicle *v) {
+    (void)road;
+    (void)lane;
+    bool *first = user;
+    if (!*first) {
+        putchar(' ');
+    }
+    fputs(vehicle_id_str(v->id), stdout);
+    *first = false;
 }
 
-int main(void) {
+int main(int argc, char *argv[]) {
+    /* Batch mode: run a whole JSON scenario in-process, no line protocol. */
+    if (argc == 4 && strcmp(argv[1], "--json") == 0) {
+        return json_run_file(argv[2], argv[3]);
+    }
+    /* Convert a JSON scenario to the binary trace format. */
+    if (argc == 4 && strcmp(argv[1], "--convert") == 0) {
+        return trace_convert_json(argv[2], argv[3]);
+    }
+    /* Replay a trace under every controller parameter combination. */
+    if (argc == 4 && strcmp(argv[1], "--sweep") == 0) {
+        return sweep_run(argv[2], argv[3], stdout);
+    }
+    /* Generate synthetic traffic from a profile: run it in memory, or
+     * write a binary trace when an output path is given. */
+    if ((argc == 3 || argc == 4) && strcmp(argv[1], "--generate") == 0) {
+        return generate_run(argv[2], argc == 4 ? argv[3] : NULL);
+    }
+    /* Multiplex many independent sessions over this one pipe. */
+    if (argc == 2 && strcmp(argv[1], "--server") == 0) {
+        return server_run(stdin, stdout);
+    }
+    /* Replay a binary trace; departures go to the optional output file. */
+    if ((argc == 3 || argc == 4) && strcmp(argv[1], "--trace") == 0) {
+        Trace trace;
+        if (trace_open(&trace, argv[2]) != 0) {
+            return 1;
+        }
+        FILE *out = NULL;
+        if (argc == 4) {
+            out = fopen(argv[3], "w");
+            if (out == NULL) {
+                fprintf(stderr, "cannot write %s\n", argv[3]);
+                trace_close(&trace);
+                return 1;
+            }
+        }
+        static Intersection trace_inter;
+        intersection_init(&trace_inter);
+        uint64_t steps = trace_replay(&trace, &trace_inter, out);
+        if (out != NULL) {
+            fclose(out);
+        }
+        fprintf(stderr, "replayed %llu steps, %u vehicles still waiting\n",
+                (unsigned long long)steps,
+                intersection_total_waiting(&trace_inter));
+        trace_close(&trace);
+        return 0;
+    }
+    /*
+     * Output batching. By default every step command flushes stdout so
+     * interactive clients (the web backend) see each response promptly.
+     * With --buffered, departures accumulate in a large user-space
+     * buffer and reach the kernel in one write() per buffer-full or per
+     * explicit 'flush' protocol command - batch replays stop paying a
+     * syscall per step.
+     */
+    bool buffered = false;
+    const char *journal_path = NULL;
+    bool recover  = false;
+    bool bad_args = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--buffered") == 0) {
+            buffered = true;
+        } else if ((strcmp(argv[i], "--journal") == 0 ||
+                    strcmp(argv[i], "--recover") == 0) && i + 1 < argc) {
+            recover      = (strcmp(argv[i], "--recover") == 0);
+            journal_path = argv[++i];
+        } else {
+            bad_args = true;
+        }
+    }
+
+    if (bad_args) {
+        fprintf(stderr,
+                "usage: %s [--buffered] [--journal new.bin | --recover existing.bin]\n"
+                "       %s [--json input.json output.json]\n"
+                "       %s [--convert input.json output.trace]\n"
+                "       %s [--trace input.trace [departures.txt]]\n"
+                "       %s [--sweep params.json input.trace]\n"
+                "       %s [--generate profile.json [output.trace]]\n"
+                "       %s [--server]\n",
+                argv[0], argv[0], argv[0], argv[0], argv[0], argv[0],
+                argv[0]);
+        return 1;
+    }
+
+    static char out_buf[1 << 20];
+    if (buffered) {
+        setvbuf(stdout, out_buf, _IOFBF, sizeof(out_buf));
+    }
+
     Intersection inter;
     intersection_init(&inter);
 
-    char line[256];
+    /* Journal mode: --recover first rebuilds the state from the existing
+     * records, then both flags append every accepted command so the next
+     * crash can recover too. */
+    Journal journal = { NULL, 0 };
+    if (journal_path != NULL) {
+        if (recover) {
+            int64_t applied = journal_replay(journal_path, &inter);
+            if (applied < 0) {
+                return 1;
+            }
+            fprintf(stderr,
+                    "recovered %lld journal records: step %u, "
+                    "%u vehicles waiting\n",
+                    (long long)applied, inter.step_count,
+                    intersection_total_waiting(&inter));
+        }
+        if (journal_open(&journal, journal_path, !recover) != 0) {
+            return 1;
+        }
+    }
+
+    /* Snapshot blobs cross the protocol hex-encoded, so lines must hold
+     * two hex chars per blob byte; everything else fits easily. */
+    enum { MAX_SNAPSHOT = sizeof(Intersection) + 64 +
+           ROAD_COUNT * LANES_PER_ROAD * MAX_VEHICLES_PER_LANE *
+           MAX_VEHICLE_ID_LEN };
+    static char line[2 * MAX_SNAPSHOT + 256];
     while (fgets(line, sizeof(line), stdin) != NULL) {
         line[strcspn(line, "\n")] = '\0';
 
@@ -30,22 +162,192 @@ int main(void) {
             if (sscanf(line, "%*s %31s %15s %15s", id, start_str, end_str) != 3) {
                 continue;
             }
-            RoadDir start = parse_road(start_str);
-            RoadDir end   = parse_road(end_str);
-            intersection_add_vehicle(&inter, start, end, id);
+            RoadDir start = road_from_name(start_str);
+            RoadDir end   = road_from_name(end_str);
+            if (intersection_add_vehicle(&inter, start, end, id)) {
+                journal_add_vehicle(&journal, start, end, id);
+            }
 
         } else if (strcmp(cmd, "step") == 0) {
-            Vehicle departed[MAX_DEPARTURES_PER_STEP];
-            uint8_t count = 0;
-            intersection_step(&inter, departed, &count);
-            for (uint8_t i = 0; i < count; i++) {
-                if (i > 0) putchar(' ');
-                fputs(departed[i].id, stdout);
+            /*
+             * "step" runs one step; "step N" runs N steps as a batch.
+             * One output line is emitted per step either way, so batch
+             * replays see the exact same stream as N single steps, but
+             * with one buffered write and one flush for the whole batch.
+             */
+            unsigned long n = 1;
+            sscanf(line, "%*s %lu", &n);
+
+            for (unsigned long s = 0; s < n; ) {
+                /* Skip empty stretches arithmetically; the per-step
+                 * blank response lines still go out. */
+                uint32_t limit = n - s > UINT32_MAX ? UINT32_MAX
+                               : (uint32_t)(n - s);
+                uint32_t skipped = intersection_fast_forward(&inter, limit);
+                if (skipped > 0) {
+                    for (uint32_t b = 0; b < skipped; b++) {
+                        putchar('\n');
+                    }
+                    s += skipped;
+                    continue;
+                }
+
+                bool first = true;
+                intersection_step_cb(&inter, print_departure, &first);
+                s++;
+                putchar('\n');
+            }
+            journal_step(&journal, (uint32_t)n);
+            if (!buffered) {
+                fflush(stdout);
+            }
+
+        } else if (strcmp(cmd, "state") == 0) {
+            /*
+             * Emit the full intersection - step counter, phase, lights,
+             * per-lane vehicle lists - as one line of compact JSON:
+             *
+             *   state {"stepCount":N,"currentPhase":P,...}
+             *
+             * This is the authoritative state the web backend previously
+             * tried to mirror in Python; one command, one line, no
+             * reconciliation.
+             */
+            static const char *LANE_NAMES[LANES_PER_ROAD] = {
+                [LANE_LEFT] = "left", [LANE_STRAIGHT] = "straight",
+                [LANE_RIGHT] = "right",
+            };
+            printf("state {\"stepCount\":%u,\"currentPhase\":%d,"
+                   "\"inYellowTransition\":%s,\"roads\":[",
+                   inter.step_count, (int)inter.current_phase,
+                   inter.in_yellow_transition ? "true" : "false");
+            for (int r = 0; r < ROAD_COUNT; r++) {
+                const TrafficLight *light = &inter.lights[r];
+                printf("%s{\"direction\":%d,\"light\":{\"state\":%d,"
+                       "\"stepsRemaining\":%u},\"lanes\":{",
+                       r > 0 ? "," : "", r, (int)light->state,
+                       light->steps_remaining);
+                for (int l = 0; l < LANES_PER_ROAD; l++) {
+                    const VehicleQueue *q = &inter.roads[r].lanes[l];
+                    printf("%s\"%s\":[", l > 0 ? "," : "", LANE_NAMES[l]);
+                    for (uint8_t i = 0; i < q->count; i++) {
+                        Vehicle v;
+                        queue_peek_at(q, i, &v);
+                        printf("%s\"%s\"", i > 0 ? "," : "",
+                               vehicle_id_str(v.id));
+                    }
+#if TSIM_SPILL_POOL
+                    /* Overflowed vehicles queue behind the ring. */
+                    for (uint8_t n = q->spill_head; n != 0;
+                         n = inter.spill_pool.nodes[n - 1].next) {
+                        printf(",\"%s\"", vehicle_id_str(
+                            inter.spill_pool.nodes[n - 1].vehicle.id));
+                    }
+#endif
+                    fputs("]", stdout);
+                }
+                fputs("}}", stdout);
+            }
+            puts("]}");
+            fflush(stdout);
+
+        } else if (strcmp(cmd, "stats") == 0) {
+            /* Per-stage step timing, one line per stage (instrumented
+             * builds only; see stepstats.h). */
+#if TSIM_STEP_TIMING
+            for (int s = 0; s < STEP_STAGE_COUNT; s++) {
+                const StageStats *st = &inter.step_stats.stages[s];
+                uint64_t avg = st->count > 0 ? st->total_ns / st->count : 0;
+                printf("stats %s count=%llu avg_ns=%llu max_ns=%llu hist=",
+                       stepstats_stage_name(s),
+                       (unsigned long long)st->count,
+                       (unsigned long long)avg,
+                       (unsigned long long)st->max_ns);
+                int top = STEP_STATS_BUCKETS - 1;
+                while (top > 0 && st->hist[top] == 0) {
+                    top--;
+                }
+                for (int b = 0; b <= top; b++) {
+                    printf("%s%llu", b > 0 ? "," : "",
+                           (unsigned long long)st->hist[b]);
+                }
+                putchar('\n');
+            }
+#else
+            puts("stats unavailable (built without TSIM_STEP_TIMING)");
+#endif
+            fflush(stdout);
+
+        } else if (strcmp(cmd, "waitHist") == 0) {
+            /* Per-road vehicle wait-time distribution, one line per
+             * road (see waithist.h). Waits are in steps; percentiles
+             * are bucket upper bounds. */
+            for (int r = 0; r < ROAD_COUNT; r++) {
+                const WaitHist *h = &inter.wait_hists[r];
+                uint64_t avg = h->count > 0 ? h->total / h->count : 0;
+                printf("waitHist %s count=%llu avg=%llu max=%u "
+                       "p50=%u p95=%u p99=%u hist=",
+                       road_name((RoadDir)r),
+                       (unsigned long long)h->count,
+                       (unsigned long long)avg, h->max,
+                       waithist_percentile(h, 0.50),
+                       waithist_percentile(h, 0.95),
+                       waithist_percentile(h, 0.99));
+                int top = WAIT_HIST_BUCKETS - 1;
+                while (top > 0 && h->buckets[top] == 0) {
+                    top--;
+                }
+                for (int b = 0; b <= top; b++) {
+                    printf("%s%llu", b > 0 ? "," : "",
+                           (unsigned long long)h->buckets[b]);
+                }
+                putchar('\n');
+            }
+            fflush(stdout);
+
+        } else if (strcmp(cmd, "flush") == 0) {
+            /* Explicit flush point for --buffered clients. */
+            journal_sync(&journal);
+            fflush(stdout);
+
+        } else if (strcmp(cmd, "snapshot") == 0) {
+            /* Emit the full state as one hex line ("snapshot <hex>"). */
+            static uint8_t blob[MAX_SNAPSHOT];
+            size_t size = intersection_save(&inter, blob, sizeof(blob));
+            fputs("snapshot ", stdout);
+            for (size_t i = 0; i < size; i++) {
+                printf("%02x", blob[i]);
             }
             putchar('\n');
             fflush(stdout);
+
+        } else if (strcmp(cmd, "restore") == 0) {
+            /* "restore <hex>" with a blob from a previous snapshot. */
+            const char *hex = line + strcspn(line, " ");
+            hex += strspn(hex, " ");
+            size_t hex_len = strlen(hex);
+
+            static uint8_t blob[MAX_SNAPSHOT];
+            bool ok = (hex_len % 2 == 0 && hex_len / 2 <= sizeof(blob));
+            size_t size = hex_len / 2;
+            for (size_t i = 0; ok && i < size; i++) {
+                char byte[3] = { hex[2 * i], hex[2 * i + 1], '\0' };
+                char *endp;
+                blob[i] = (uint8_t)strtoul(byte, &endp, 16);
+                ok = (*endp == '\0');
+            }
+            ok = ok && intersection_load(&inter, blob, size);
+            if (ok) {
+                /* The journal cannot represent a wholesale state swap;
+                 * from here on recovery needs this snapshot plus the
+                 * journal tail, so drop the now-stale records. */
+                journal_reset(&journal);
+            }
+            puts(ok ? "restored" : "error");
+            fflush(stdout);
         }
     }
 
+    journal_close(&journal);
     return 0;
 }
@@ -34,31 +34,151 @@ Lane lane_for_movement(MovementType movement) {
     }
 }
 
+RoadDir road_from_name(const char *name) {
+    if (strcmp(name, "north") == 0) return ROAD_NORTH;
+    if (strcmp(name, "south") == 0) return ROAD_SOUTH;
+    if (strcmp(name, "east")  == 0) return ROAD_EAST;
+    if (strcmp(name, "west")  == 0) return ROAD_WEST;
+    return ROAD_NONE;
+}
+
+const char *road_name(RoadDir dir) {
+    switch (dir) {
+        case ROAD_NORTH: return "north";
+        case ROAD_SOUTH: return "south";
+        case ROAD_EAST:  return "east";
+        case ROAD_WEST:  return "west";
+        default:         return "none";
+    }
+}
+
 /*
  * VehicleQueue operations
+ *
+ * The ring is structure-of-arrays (see types.h); these two helpers are
+ * the only places a Vehicle is scattered into or gathered out of the
+ * parallel arrays.
  */
 
+static void queue_slot_store(VehicleQueue *q, uint8_t slot,
+                             const Vehicle *v) {
+    q->ids[slot]           = v->id;
+    q->enqueue_steps[slot] = v->enqueue_step;
+    q->end_roads[slot]     = v->end_road;
+    q->movements[slot]     = v->movement;
+}
+
+static void queue_slot_load(const VehicleQueue *q, uint8_t slot,
+                            Vehicle *out) {
+    out->id           = q->ids[slot];
+    out->enqueue_step = q->enqueue_steps[slot];
+    out->end_road     = q->end_roads[slot];
+    out->movement     = q->movements[slot];
+}
+
 void queue_init(VehicleQueue *q) {
     q->head  = 0;
     q->tail  = 0;
     q->count = 0;
+    q->enqueue_step_sum = 0;
+#if TSIM_SPILL_POOL
+    q->spill       = NULL;
+    q->spill_head  = 0;
+    q->spill_tail  = 0;
+    q->spill_count = 0;
+#endif
 }
 
+#if TSIM_SPILL_POOL
+
+void spill_pool_init(SpillPool *pool) {
+    /* Chain every node onto the free list (links are index + 1). */
+    for (int i = 0; i < SPILL_POOL_SIZE; i++) {
+        pool->nodes[i].next = (uint8_t)(i + 2 <= SPILL_POOL_SIZE ? i + 2 : 0);
+    }
+    pool->free_head = 1;
+}
+
+void queue_attach_spill(VehicleQueue *q, SpillPool *pool) {
+    q->spill = pool;
+}
+
+/* Append to the lane's spill FIFO; false if no pool or pool exhausted. */
+static bool spill_enqueue(VehicleQueue *q, const Vehicle *v) {
+    SpillPool *pool = q->spill;
+    if (pool == NULL || pool->free_head == 0) {
+        return false;
+    }
+    uint8_t idx = pool->free_head;
+    SpillNode *node = &pool->nodes[idx - 1];
+    pool->free_head = node->next;
+
+    node->vehicle = *v;
+    node->next    = 0;
+    if (q->spill_tail != 0) {
+        pool->nodes[q->spill_tail - 1].next = idx;
+    } else {
+        q->spill_head = idx;
+    }
+    q->spill_tail = idx;
+    q->spill_count++;
+    q->enqueue_step_sum += v->enqueue_step;
+    return true;
+}
+
+/* Move the oldest spilled vehicle into the freed ring slot. */
+static void spill_refill(VehicleQueue *q) {
+    SpillPool *pool = q->spill;
+    uint8_t    idx  = q->spill_head;
+    SpillNode *node = &pool->nodes[idx - 1];
+
+    queue_slot_store(q, q->tail, &node->vehicle);
+    q->tail = (uint8_t)((q->tail + 1) % MAX_VEHICLES_PER_LANE);
+    q->count++;
+
+    q->spill_head = node->next;
+    if (q->spill_head == 0) {
+        q->spill_tail = 0;
+    }
+    q->spill_count--;
+    node->next      = pool->free_head;
+    pool->free_head = idx;
+}
+
+#endif /* TSIM_SPILL_POOL */
+
 bool queue_is_empty(const VehicleQueue *q) {
     return q->count == 0;
 }
 
 bool queue_is_full(const VehicleQueue *q) {
+#if TSIM_SPILL_POOL
+    if (q->count >= MAX_VEHICLES_PER_LANE) {
+        return q->spill == NULL || q->spill->free_head == 0;
+    }
+    return false;
+#else
     return q->count >= MAX_VEHICLES_PER_LANE;
+#endif
 }
 
 bool queue_enqueue(VehicleQueue *q, const Vehicle *v) {
+#if TSIM_SPILL_POOL
+    /* Once anything has spilled, later arrivals must spill too or they
+     * would overtake the spilled vehicles; the ring refills from the
+     * spill FIFO on dequeue, so spill_count > 0 implies a full ring. */
+    if (q->count >= MAX_VEHICLES_PER_LANE || q->spill_count > 0) {
+        return spill_enqueue(q, v);
+    }
+#else
     if (queue_is_full(q)) {
         return false;
     }
-    q->buf[q->tail] = *v;
+#endif
+    queue_slot_store(q, q->tail, v);
     q->tail = (uint8_t)((q->tail + 1) % MAX_VEHICLES_PER_LANE);
     q->count++;
+    q->enqueue_step_sum += v->enqueue_step;
     return true;
 }
 
@@ -67,10 +187,16 @@ bool queue_dequeue(VehicleQueue *q, Vehicle *out) {
         return false;
     }
     if (out != NULL) {
-        *out = q->buf[q->head];
+        queue_slot_load(q, q->head, out);
     }
+    q->enqueue_step_sum -= q->enqueue_steps[q->head];
     q->head = (uint8_t)((q->head + 1) % MAX_VEHICLES_PER_LANE);
     q->count--;
+#if TSIM_SPILL_POOL
+    if (q->spill_count > 0) {
+        spill_refill(q);
+    }
+#endif
     return true;
 }
 
@@ -78,10 +204,29 @@ bool queue_peek(const VehicleQueue *q, Vehicle *out) {
     if (queue_is_empty(q)) {
         return false;
     }
-    *out = q->buf[q->head];
+    queue_slot_load(q, q->head, out);
+    return true;
+}
+
+bool queue_peek_at(const VehicleQueue *q, uint8_t index, Vehicle *out) {
+    if (index >= q->count) {
+        return false;
+    }
+    queue_slot_load(q, (uint8_t)((q->head + index) % MAX_VEHICLES_PER_LANE),
+                    out);
     return true;
 }
 
+uint64_t queue_total_wait(const VehicleQueue *q, uint32_t now) {
+    /* Each queued vehicle has waited (now - enqueue_step); summed over
+     * the lane that is count * now minus the running enqueue sum. */
+#if TSIM_SPILL_POOL
+    return (uint64_t)(q->count + q->spill_count) * now - q->enqueue_step_sum;
+#else
+    return (uint64_t)q->count * now - q->enqueue_step_sum;
+#endif
+}
+
 /*
  * Road operations
  */ 
@@ -118,13 +263,26 @@ uint8_t road_lane_count(const Road *r, Lane lane) {
     if (lane >= LANES_PER_ROAD) {
         return 0;
     }
+#if TSIM_SPILL_POOL
+    /* Ring plus overflow; bounded by 64 + SPILL_POOL_SIZE, still < 255. */
+    return (uint8_t)(r->lanes[lane].count + r->lanes[lane].spill_count);
+#else
     return r->lanes[lane].count;
+#endif
 }
 
 uint8_t road_total_count(const Road *r) {
     uint8_t total = 0;
     for (int i = 0; i < LANES_PER_ROAD; i++) {
-        total += r->lanes[i].count;
+        total += road_lane_count(r, (Lane)i);
+    }
+    return total;
+}
+
+uint64_t road_total_wait(const Road *r, uint32_t now) {
+    uint64_t total = 0;
+    for (int i = 0; i < LANES_PER_ROAD; i++) {
+        total += queue_total_wait(&r->lanes[i], now);
     }
     return total;
 }
@@ -0,0 +1,41 @@
+#include "sensor_queue.h"
+
+/*
+ * Same SPSC scheme as handoff.c: the producer only writes 'tail', the
+ * consumer only writes 'head'. Release on the writer side publishes the
+ * slot before the index moves; acquire on the reader side orders the
+ * index read before the slot read. On Cortex-M this compiles to plain
+ * loads and stores plus compiler barriers, so it is safe to call
+ * sensor_queue_push() from any interrupt priority.
+ */
+
+#define QUEUE_MASK (SENSOR_QUEUE_SIZE - 1u)
+
+void sensor_queue_init(SensorQueue *queue) {
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+}
+
+bool sensor_queue_push(SensorQueue *queue, const SensorEvent *event) {
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+
+    if (tail - head >= SENSOR_QUEUE_SIZE - 1u) {
+        return false; /* full */
+    }
+    queue->buf[tail & QUEUE_MASK] = *event;
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+bool sensor_queue_pop(SensorQueue *queue, SensorEvent *out) {
+    uint32_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+
+    if (head == tail) {
+        return false; /* empty */
+    }
+    *out = queue->buf[head & QUEUE_MASK];
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return true;
+}
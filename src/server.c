@@ -0,0 +1,145 @@
+#include "server.h"
+#include "intern.h"
+#include "intersection.h"
+#include "road.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Sessions live in a growable array of Intersection pointers; the
+ * session id is the array index. 'create' reuses the lowest free slot,
+ * so long-running servers with session churn stay compact, and a
+ * session costs exactly one malloc'd Intersection - nothing per session
+ * beyond the simulation state itself.
+ */
+
+typedef struct {
+    Intersection **slots;
+    uint32_t       cap;
+} SessionPool;
+
+static Intersection *pool_get(SessionPool *pool, unsigned long id) {
+    if (id >= pool->cap) {
+        return NULL;
+    }
+    return pool->slots[id];
+}
+
+/* Returns the new session's id, or UINT32_MAX on allocation failure. */
+static uint32_t pool_create(SessionPool *pool) {
+    uint32_t id = 0;
+    while (id < pool->cap && pool->slots[id] != NULL) {
+        id++;
+    }
+    if (id == pool->cap) {
+        uint32_t new_cap = pool->cap > 0 ? pool->cap * 2 : 16;
+        Intersection **slots =
+            realloc(pool->slots, new_cap * sizeof(*slots));
+        if (slots == NULL) {
+            return UINT32_MAX;
+        }
+        memset(&slots[pool->cap], 0,
+               (new_cap - pool->cap) * sizeof(*slots));
+        pool->slots = slots;
+        pool->cap   = new_cap;
+    }
+
+    Intersection *inter = malloc(sizeof(*inter));
+    if (inter == NULL) {
+        return UINT32_MAX;
+    }
+    intersection_init(inter);
+    pool->slots[id] = inter;
+    return id;
+}
+
+int server_run(FILE *in, FILE *out) {
+    SessionPool pool = { NULL, 0 };
+
+    char line[256];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        line[strcspn(line, "\n")] = '\0';
+
+        char cmd[32];
+        if (sscanf(line, "%31s", cmd) != 1) {
+            continue;
+        }
+
+        if (strcmp(cmd, "create") == 0) {
+            uint32_t id = pool_create(&pool);
+            if (id == UINT32_MAX) {
+                fputs("error out of memory\n", out);
+            } else {
+                fprintf(out, "created %u\n", id);
+            }
+            fflush(out);
+
+        } else if (strcmp(cmd, "destroy") == 0) {
+            unsigned long id;
+            if (sscanf(line, "%*s %lu", &id) != 1) {
+                continue;
+            }
+            Intersection *inter = pool_get(&pool, id);
+            if (inter == NULL) {
+                fprintf(out, "error unknown session %lu\n", id);
+            } else {
+                free(inter);
+                pool.slots[id] = NULL;
+                fprintf(out, "destroyed %lu\n", id);
+            }
+            fflush(out);
+
+        } else if (strcmp(cmd, "addVehicle") == 0) {
+            unsigned long id;
+            char vid[MAX_VEHICLE_ID_LEN];
+            char start_str[16], end_str[16];
+            if (sscanf(line, "%*s %lu %31s %15s %15s",
+                       &id, vid, start_str, end_str) != 4) {
+                continue;
+            }
+            Intersection *inter = pool_get(&pool, id);
+            if (inter == NULL) {
+                fprintf(out, "error unknown session %lu\n", id);
+                fflush(out);
+                continue;
+            }
+            intersection_add_vehicle(inter, road_from_name(start_str),
+                                     road_from_name(end_str), vid);
+
+        } else if (strcmp(cmd, "step") == 0) {
+            unsigned long id;
+            unsigned long n = 1;
+            int fields = sscanf(line, "%*s %lu %lu", &id, &n);
+            if (fields < 1) {
+                continue;
+            }
+            Intersection *inter = pool_get(&pool, id);
+            if (inter == NULL) {
+                fprintf(out, "error unknown session %lu\n", id);
+                fflush(out);
+                continue;
+            }
+            /* Same per-step departure lines as single-session mode. */
+            for (unsigned long s = 0; s < n; s++) {
+                Vehicle departed[MAX_DEPARTURES_PER_STEP];
+                uint8_t count = 0;
+                intersection_step(inter, departed, &count);
+                for (uint8_t i = 0; i < count; i++) {
+                    if (i > 0) fputc(' ', out);
+                    fputs(vehicle_id_str(departed[i].id), out);
+                }
+                fputc('\n', out);
+            }
+            fflush(out);
+
+        } else if (strcmp(cmd, "flush") == 0) {
+            fflush(out);
+        }
+    }
+
+    for (uint32_t i = 0; i < pool.cap; i++) {
+        free(pool.slots[i]);
+    }
+    free(pool.slots);
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include "sim_api.h"
+#include "intersection.h"
+#include "intern.h"
+#include "road.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The opaque handle is just the intersection. Extra per-session state
+ * (instrumentation, pools) can be added here later without touching the
+ * public header.
+ */
+struct Sim {
+    Intersection inter;
+};
+
+Sim *sim_create(void) {
+    Sim *sim = malloc(sizeof(*sim));
+    if (sim == NULL) {
+        return NULL;
+    }
+    intersection_init(&sim->inter);
+    return sim;
+}
+
+void sim_destroy(Sim *sim) {
+    free(sim);
+}
+
+void sim_reset(Sim *sim) {
+    intersection_init(&sim->inter);
+}
+
+int sim_add_vehicle(Sim *sim, const char *start_road, const char *end_road,
+                    const char *vehicle_id) {
+    RoadDir start = road_from_name(start_road);
+    RoadDir end   = road_from_name(end_road);
+    return intersection_add_vehicle(&sim->inter, start, end, vehicle_id) ? 1 : 0;
+}
+
+int sim_step(Sim *sim, char *departed, int departed_cap) {
+    Vehicle dep[MAX_DEPARTURES_PER_STEP];
+    uint8_t count = 0;
+    intersection_step(&sim->inter, dep, &count);
+
+    if (departed != NULL && departed_cap > 0) {
+        int n = 0;
+        departed[0] = '\0';
+        for (uint8_t i = 0; i < count; i++) {
+            const char *id  = vehicle_id_str(dep[i].id);
+            int         len = (int)strlen(id);
+            /* " " separator before every entry but the first */
+            int needed = len + (i > 0 ? 1 : 0);
+            if (n + needed + 1 > departed_cap) {
+                break;
+            }
+            if (i > 0) {
+                departed[n++] = ' ';
+            }
+            memcpy(departed + n, id, (size_t)len + 1);
+            n += len;
+        }
+    }
+    return count;
+}
+
+void sim_state(const Sim *sim, SimStateView *out) {
+    const Intersection *inter = &sim->inter;
+
+    out->step_count    = inter->step_count;
+    out->current_phase = (uint8_t)inter->current_phase;
+    out->total_waiting = intersection_total_waiting(inter);
+
+    for (int r = 0; r < ROAD_COUNT; r++) {
+        out->lights[r] = (uint8_t)inter->lights[r].state;
+        for (int l = 0; l < LANES_PER_ROAD; l++) {
+            out->lane_counts[r][l] = road_lane_count(&inter->roads[r], (Lane)l);
+        }
+    }
+}
+
+int sim_wait_stats(const Sim *sim, const char *road, SimWaitStats *out) {
+    RoadDir dir = road_from_name(road);
+    if (dir >= ROAD_COUNT) {
+        return 0;
+    }
+    const WaitHist *h = &sim->inter.wait_hists[dir];
+    out->count       = h->count;
+    out->total_steps = h->total;
+    out->max_steps   = h->max;
+    out->p50         = waithist_percentile(h, 0.50);
+    out->p95         = waithist_percentile(h, 0.95);
+    out->p99         = waithist_percentile(h, 0.99);
+    return 1;
+}
@@ -7,10 +7,51 @@
 void simulation_init(SimulationContext *ctx) {
     memset(ctx, 0, sizeof(*ctx));
     intersection_init(&ctx->inter);
+    sensor_queue_init(&ctx->sensor_events);
+}
+
+/* Enqueue one freshly numbered vehicle in the given lane. */
+static void enqueue_arrival(SimulationContext *ctx, RoadDir road, Lane lane) {
+#if TSIM_NO_VEHICLE_IDS
+    /* The intern stub hands out bare counters without reading the
+     * string, so the tick path does no formatting at all. */
+    ++ctx->vehicle_counter;
+    intersection_add_vehicle_by_lane(&ctx->inter, road, lane, "");
+#else
+    char id[MAX_VEHICLE_ID_LEN];
+    snprintf(id, sizeof(id), "v%"PRIu32, ++ctx->vehicle_counter);
+    intersection_add_vehicle_by_lane(&ctx->inter, road, lane, id);
+#endif
+}
+
+bool simulation_sensor_isr(SimulationContext *ctx, RoadDir road, Lane lane,
+                           uint32_t timestamp) {
+    SensorEvent event = {
+        .road      = (uint8_t)road,
+        .lane      = (uint8_t)lane,
+        .timestamp = timestamp,
+    };
+    return sensor_queue_push(&ctx->sensor_events, &event);
 }
 
 void simulation_tick(SimulationContext *ctx, const EmbeddedHAL *hal) {
-    /* 1. Edge-detect new arrivals.
+    /* 1. Drain interrupt-reported edges.
+     *
+     * Each event is one rising edge caught by an EXTI handler, so every
+     * event is one vehicle - including sensors that tripped and cleared
+     * between two ticks, which the poll below would have missed.
+     * Marking the lane as already-sensed keeps step 2 from counting the
+     * same vehicle again if its sensor is still occupied. */
+    SensorEvent event;
+    while (sensor_queue_pop(&ctx->sensor_events, &event)) {
+        if (event.road >= ROAD_COUNT || event.lane >= LANES_PER_ROAD) {
+            continue;
+        }
+        enqueue_arrival(ctx, (RoadDir)event.road, (Lane)event.lane);
+        ctx->prev_sense[event.road][event.lane] = true;
+    }
+
+    /* 2. Edge-detect new arrivals.
      *
      * A vehicle is enqueued exactly once: on the step where the sensor
      * transitions from clear to occupied. Subsequent steps where the
@@ -20,22 +61,24 @@ void simulation_tick(SimulationContext *ctx, const EmbeddedHAL *hal) {
         for (int l = 0; l < LANES_PER_ROAD; l++) {
             bool now = hal->sense_lane((RoadDir)r, (Lane)l);
             if (now && !ctx->prev_sense[r][l]) {
-                char id[MAX_VEHICLE_ID_LEN];
-                snprintf(id, sizeof(id), "v%"PRIu32, ++ctx->vehicle_counter);
-                intersection_add_vehicle_by_lane(&ctx->inter,
-                                                 (RoadDir)r, (Lane)l, id);
+                enqueue_arrival(ctx, (RoadDir)r, (Lane)l);
             }
             ctx->prev_sense[r][l] = now;
         }
     }
 
-    /* 2. Advance the intersection by one simulation step. */
+    /* 3. Advance the intersection by one simulation step. */
     Vehicle departed[MAX_DEPARTURES_PER_STEP];
     uint8_t count;
     intersection_step(&ctx->inter, departed, &count);
 
-    /* 3. Reflect the new light states on the physical hardware. */
+    /* 4. Reflect the new light states on the physical hardware. A
+     * batching HAL only stages per-road patterns in set_light() and
+     * flushes them in one go here. */
     for (int r = 0; r < ROAD_COUNT; r++) {
         hal->set_light((RoadDir)r, ctx->inter.lights[r].state);
     }
+    if (hal->commit_lights != NULL) {
+        hal->commit_lights();
+    }
 }
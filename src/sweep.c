@@ -0,0 +1,313 @@
+#include "sweep.h"
+#include "intersection.h"
+#include "trace.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * The sweep is embarrassingly parallel: every combination replays the
+ * shared read-only trace into its own Intersection, so workers never
+ * touch each other's state. Work is handed out through one atomic
+ * index (combinations vary wildly in cost - a tight max_green drains
+ * queues slower - so static partitioning would leave cores idle), and
+ * results land in a preallocated slot per combination, keeping the
+ * report in grid order no matter which worker ran what.
+ */
+
+#define SWEEP_MAX_VALUES 32  /* candidate values per knob */
+
+typedef struct {
+    uint32_t values[SWEEP_MAX_VALUES];
+    uint32_t count;
+} SweepAxis;
+
+typedef struct {
+    SweepAxis min_green;
+    SweepAxis max_green;
+    SweepAxis yellow;
+} SweepParams;
+
+typedef struct {
+    ControllerParams params;
+    uint64_t         steps;
+    uint64_t         departed;
+    uint64_t         wait_sum;   /* total steps waited by departed vehicles */
+    uint32_t         max_wait;
+    uint8_t          remaining;  /* vehicles still queued at end of trace */
+} SweepResult;
+
+typedef struct {
+    const Trace *trace;
+    SweepResult *results;
+    uint32_t     result_count;
+    atomic_uint  next;           /* work handout index */
+} SweepJob;
+
+/* ----------------------------------------------------------------------
+ * Parameter file parsing (same minimal-scanner approach as json_runner.c,
+ * but for a flat object of integer arrays)
+ * ------------------------------------------------------------------- */
+
+typedef struct {
+    const char *p;
+    const char *end;
+} ParamCursor;
+
+static void pc_skip_ws(ParamCursor *c) {
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' ||
+                             *c->p == '\n' || *c->p == '\r')) {
+        c->p++;
+    }
+}
+
+static bool pc_accept(ParamCursor *c, char ch) {
+    pc_skip_ws(c);
+    if (c->p < c->end && *c->p == ch) {
+        c->p++;
+        return true;
+    }
+    return false;
+}
+
+static bool pc_parse_key(ParamCursor *c, char *out, size_t cap) {
+    if (!pc_accept(c, '"')) {
+        return false;
+    }
+    size_t n = 0;
+    while (c->p < c->end && *c->p != '"') {
+        if (n + 1 < cap) {
+            out[n++] = *c->p;
+        }
+        c->p++;
+    }
+    out[n] = '\0';
+    return pc_accept(c, '"');
+}
+
+static bool pc_parse_uint(ParamCursor *c, uint32_t *out) {
+    pc_skip_ws(c);
+    if (c->p >= c->end || *c->p < '0' || *c->p > '9') {
+        return false;
+    }
+    uint32_t value = 0;
+    while (c->p < c->end && *c->p >= '0' && *c->p <= '9') {
+        value = value * 10 + (uint32_t)(*c->p - '0');
+        c->p++;
+    }
+    *out = value;
+    return true;
+}
+
+static bool pc_parse_axis(ParamCursor *c, SweepAxis *axis) {
+    axis->count = 0;
+    if (!pc_accept(c, '[')) {
+        return false;
+    }
+    if (pc_accept(c, ']')) {
+        return false; /* an empty axis would make the grid empty */
+    }
+    do {
+        uint32_t value;
+        if (!pc_parse_uint(c, &value) || axis->count >= SWEEP_MAX_VALUES) {
+            return false;
+        }
+        axis->values[axis->count++] = value;
+    } while (pc_accept(c, ','));
+    return pc_accept(c, ']');
+}
+
+static int parse_params_file(const char *path, SweepParams *params) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        fprintf(stderr, "sweep: cannot read %s\n", path);
+        return 1;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *text = malloc((size_t)size + 1);
+    if (text == NULL || fread(text, 1, (size_t)size, f) != (size_t)size) {
+        free(text);
+        fclose(f);
+        fprintf(stderr, "sweep: cannot read %s\n", path);
+        return 1;
+    }
+    text[size] = '\0';
+    fclose(f);
+
+    memset(params, 0, sizeof(*params));
+    ParamCursor c = { text, text + size };
+    bool ok = pc_accept(&c, '{') && !pc_accept(&c, '}');
+
+    while (ok) {
+        char key[16];
+        ok = pc_parse_key(&c, key, sizeof(key)) && pc_accept(&c, ':');
+        if (!ok) {
+            break;
+        }
+        if (strcmp(key, "min_green") == 0) {
+            ok = pc_parse_axis(&c, &params->min_green);
+        } else if (strcmp(key, "max_green") == 0) {
+            ok = pc_parse_axis(&c, &params->max_green);
+        } else if (strcmp(key, "yellow") == 0) {
+            ok = pc_parse_axis(&c, &params->yellow);
+        } else {
+            ok = false; /* unknown knob: likely a typo, refuse to guess */
+        }
+        if (ok && !pc_accept(&c, ',')) {
+            ok = pc_accept(&c, '}');
+            break;
+        }
+    }
+
+    free(text);
+    if (!ok || params->min_green.count == 0 || params->max_green.count == 0 ||
+        params->yellow.count == 0) {
+        fprintf(stderr, "sweep: malformed parameter file %s "
+                        "(need min_green, max_green and yellow arrays)\n",
+                path);
+        return 1;
+    }
+    return 0;
+}
+
+/* ----------------------------------------------------------------------
+ * Replay and workers
+ * ------------------------------------------------------------------- */
+
+static void replay_one(const Trace *trace, SweepResult *result) {
+    /* Intersection is large; one worker replays many combinations, so
+     * heap-allocate once per call rather than growing the stack. */
+    Intersection *inter = malloc(sizeof(*inter));
+    if (inter == NULL) {
+        return;
+    }
+    intersection_init(inter);
+    intersection_set_params(inter, &result->params);
+
+    for (uint64_t i = 0; i < trace->record_count; i++) {
+        const TraceRecord *rec = &trace->records[i];
+        if (rec->opcode == TRACE_OP_ADD_VEHICLE) {
+            intersection_add_vehicle_interned(inter, (RoadDir)rec->start_road,
+                                              (RoadDir)rec->end_road,
+                                              trace->id_map[rec->arg]);
+        } else if (rec->opcode == TRACE_OP_STEP) {
+            for (uint32_t s = 0; s < rec->arg; s++) {
+                Vehicle departed[MAX_DEPARTURES_PER_STEP];
+                uint8_t count;
+                intersection_step(inter, departed, &count);
+                for (uint8_t d = 0; d < count; d++) {
+                    uint32_t wait = (inter->step_count - 1) -
+                                    departed[d].enqueue_step;
+                    result->wait_sum += wait;
+                    if (wait > result->max_wait) {
+                        result->max_wait = wait;
+                    }
+                }
+                result->departed += count;
+            }
+            result->steps += rec->arg;
+        }
+    }
+
+    result->remaining = intersection_total_waiting(inter);
+    free(inter);
+}
+
+static void *sweep_worker(void *arg) {
+    SweepJob *job = arg;
+
+    for (;;) {
+        uint32_t i = atomic_fetch_add(&job->next, 1);
+        if (i >= job->result_count) {
+            return NULL;
+        }
+        replay_one(job->trace, &job->results[i]);
+    }
+}
+
+int sweep_run(const char *params_path, const char *trace_path, FILE *out) {
+    SweepParams params;
+    if (parse_params_file(params_path, &params) != 0) {
+        return 1;
+    }
+
+    Trace trace;
+    if (trace_open(&trace, trace_path) != 0) {
+        return 1;
+    }
+
+    /* Build the grid up front; workers fill in the metrics. */
+    uint32_t capacity = params.min_green.count * params.max_green.count *
+                        params.yellow.count;
+    SweepResult *results = calloc(capacity, sizeof(SweepResult));
+    if (results == NULL) {
+        trace_close(&trace);
+        fprintf(stderr, "sweep: out of memory\n");
+        return 1;
+    }
+    uint32_t count = 0;
+    for (uint32_t m = 0; m < params.min_green.count; m++) {
+        for (uint32_t x = 0; x < params.max_green.count; x++) {
+            for (uint32_t y = 0; y < params.yellow.count; y++) {
+                if (params.max_green.values[x] <
+                    params.min_green.values[m]) {
+                    continue; /* nonsense combination */
+                }
+                results[count++].params = (ControllerParams){
+                    .min_green_steps = (uint8_t)params.min_green.values[m],
+                    .max_green_steps = (uint8_t)params.max_green.values[x],
+                    .yellow_steps    = (uint8_t)params.yellow.values[y],
+                };
+            }
+        }
+    }
+
+    SweepJob job = { &trace, results, count, 0 };
+    long nproc = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t workers = nproc > 1 ? (uint32_t)nproc : 1;
+    if (workers > count) {
+        workers = count;
+    }
+
+    if (workers > 1) {
+        pthread_t *threads = malloc(workers * sizeof(pthread_t));
+        if (threads == NULL) {
+            workers = 1;
+        } else {
+            for (uint32_t w = 0; w < workers; w++) {
+                pthread_create(&threads[w], NULL, sweep_worker, &job);
+            }
+            for (uint32_t w = 0; w < workers; w++) {
+                pthread_join(threads[w], NULL);
+            }
+            free(threads);
+        }
+    }
+    if (workers <= 1) {
+        sweep_worker(&job);
+    }
+
+    fputs("min_green,max_green,yellow,steps,departed,remaining,"
+          "avg_wait,max_wait\n", out);
+    for (uint32_t i = 0; i < count; i++) {
+        const SweepResult *r = &results[i];
+        double avg_wait = r->departed > 0
+                        ? (double)r->wait_sum / (double)r->departed
+                        : 0.0;
+        fprintf(out, "%u,%u,%u,%llu,%llu,%u,%.3f,%u\n",
+                r->params.min_green_steps, r->params.max_green_steps,
+                r->params.yellow_steps,
+                (unsigned long long)r->steps,
+                (unsigned long long)r->departed,
+                r->remaining, avg_wait, r->max_wait);
+    }
+
+    free(results);
+    trace_close(&trace);
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include "trace.h"
+#include "intern.h"
+#include "intersection.h"
+#include "json_runner.h"
+#include "road.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Sentinel for "interned handle has no file index yet". */
+#define NO_FILE_HANDLE UINT32_MAX
+
+/* -------------------------------------------------------------------------
+ * Reading
+ * ---------------------------------------------------------------------- */
+
+int trace_open(Trace *trace, const char *path) {
+    memset(trace, 0, sizeof(*trace));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "trace: cannot open %s\n", path);
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TraceHeader)) {
+        fprintf(stderr, "trace: %s is not a trace file\n", path);
+        close(fd);
+        return 1;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); /* the mapping keeps the file alive */
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "trace: mmap of %s failed\n", path);
+        return 1;
+    }
+
+    const TraceHeader *hdr = base;
+    size_t records_end = sizeof(TraceHeader) +
+                         hdr->record_count * sizeof(TraceRecord);
+    if (memcmp(hdr->magic, TRACE_MAGIC, 4) != 0 ||
+        hdr->version != TRACE_VERSION ||
+        records_end > (size_t)st.st_size) {
+        fprintf(stderr, "trace: %s has a bad header\n", path);
+        munmap(base, (size_t)st.st_size);
+        return 1;
+    }
+
+    trace->map_base     = base;
+    trace->map_size     = (size_t)st.st_size;
+    trace->records      = (const TraceRecord *)((const char *)base +
+                                                sizeof(TraceHeader));
+    trace->record_count = hdr->record_count;
+
+    /* Intern the string table once; records then resolve IDs with one
+     * array lookup instead of a hash per vehicle. */
+    trace->id_count = hdr->string_count;
+    trace->id_map   = malloc((size_t)hdr->string_count * sizeof(uint32_t));
+    const char *s   = (const char *)base + records_end;
+    const char *end = (const char *)base + st.st_size;
+    for (uint32_t i = 0; i < hdr->string_count; i++) {
+        if (s >= end || memchr(s, '\0', (size_t)(end - s)) == NULL) {
+            fprintf(stderr, "trace: %s has a truncated string table\n", path);
+            trace_close(trace);
+            return 1;
+        }
+        trace->id_map[i] = vehicle_id_intern(s);
+        s += strlen(s) + 1;
+    }
+    return 0;
+}
+
+void trace_close(Trace *trace) {
+    if (trace->map_base != NULL) {
+        munmap(trace->map_base, trace->map_size);
+    }
+    free(trace->id_map);
+    memset(trace, 0, sizeof(*trace));
+}
+
+uint64_t trace_replay(const Trace *trace, Intersection *inter, FILE *out) {
+    uint64_t steps = 0;
+
+    for (uint64_t i = 0; i < trace->record_count; i++) {
+        const TraceRecord *rec = &trace->records[i];
+
+        if (rec->opcode == TRACE_OP_ADD_VEHICLE) {
+            if (rec->arg < trace->id_count) {
+                intersection_add_vehicle_interned(inter,
+                                                  (RoadDir)rec->start_road,
+                                                  (RoadDir)rec->end_road,
+                                                  trace->id_map[rec->arg]);
+            }
+        } else if (rec->opcode == TRACE_OP_STEP) {
+            uint32_t n = 0;
+            while (n < rec->arg) {
+                /* Empty stretches (overnight hours in recorded traces)
+                 * are skipped arithmetically; only the per-step blank
+                 * output lines remain. */
+                uint32_t skipped =
+                    intersection_fast_forward(inter, rec->arg - n);
+                if (skipped > 0) {
+                    n     += skipped;
+                    steps += skipped;
+                    if (out != NULL) {
+                        for (uint32_t s = 0; s < skipped; s++) {
+                            fputc('\n', out);
+                        }
+                    }
+                    continue;
+                }
+
+                Vehicle departed[MAX_DEPARTURES_PER_STEP];
+                uint8_t count = 0;
+                intersection_step(inter, departed, &count);
+                n++;
+                steps++;
+                if (out != NULL) {
+                    for (uint8_t d = 0; d < count; d++) {
+                        if (d > 0) fputc(' ', out);
+                        fputs(vehicle_id_str(departed[d].id), out);
+                    }
+                    fputc('\n', out);
+                }
+            }
+        }
+    }
+    return steps;
+}
+
+/* -------------------------------------------------------------------------
+ * Writing
+ * ---------------------------------------------------------------------- */
+
+int trace_writer_open(TraceWriter *w, const char *path) {
+    memset(w, 0, sizeof(*w));
+    w->f = fopen(path, "wb");
+    if (w->f == NULL) {
+        fprintf(stderr, "trace: cannot write %s\n", path);
+        return 1;
+    }
+    /* Placeholder header; trace_writer_close() rewrites it. */
+    TraceHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    fwrite(&hdr, sizeof(hdr), 1, w->f);
+    return 0;
+}
+
+static void writer_flush_steps(TraceWriter *w) {
+    if (w->pending_steps == 0) {
+        return;
+    }
+    TraceRecord rec = { TRACE_OP_STEP, 0, 0, 0, w->pending_steps };
+    fwrite(&rec, sizeof(rec), 1, w->f);
+    w->record_count++;
+    w->pending_steps = 0;
+}
+
+void trace_writer_add_vehicle(TraceWriter *w, RoadDir start, RoadDir end,
+                              const char *id) {
+    writer_flush_steps(w);
+
+    uint32_t handle = vehicle_id_intern(id);
+
+    if (handle >= w->file_handle_cap) {
+        uint32_t cap = w->file_handle_cap ? w->file_handle_cap : 256;
+        while (cap <= handle) cap *= 2;
+        w->file_handle = realloc(w->file_handle, cap * sizeof(uint32_t));
+        for (uint32_t i = w->file_handle_cap; i < cap; i++) {
+            w->file_handle[i] = NO_FILE_HANDLE;
+        }
+        w->file_handle_cap = cap;
+    }
+
+    if (w->file_handle[handle] == NO_FILE_HANDLE) {
+        if (w->string_count == w->strings_cap) {
+            w->strings_cap = w->strings_cap ? w->strings_cap * 2 : 256;
+            w->strings = realloc(w->strings,
+                                 w->strings_cap * sizeof(*w->strings));
+        }
+        w->strings[w->string_count] = vehicle_id_str(handle);
+        w->file_handle[handle]      = w->string_count++;
+    }
+
+    TraceRecord rec = { TRACE_OP_ADD_VEHICLE, (uint8_t)start, (uint8_t)end,
+                        0, w->file_handle[handle] };
+    fwrite(&rec, sizeof(rec), 1, w->f);
+    w->record_count++;
+}
+
+void trace_writer_step(TraceWriter *w, uint32_t count) {
+    w->pending_steps += count;
+}
+
+int trace_writer_close(TraceWriter *w) {
+    writer_flush_steps(w);
+
+    for (uint32_t i = 0; i < w->string_count; i++) {
+        fwrite(w->strings[i], strlen(w->strings[i]) + 1, 1, w->f);
+    }
+
+    TraceHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, TRACE_MAGIC, 4);
+    hdr.version      = TRACE_VERSION;
+    hdr.record_count = w->record_count;
+    hdr.string_count = w->string_count;
+
+    int rc = 0;
+    if (fseek(w->f, 0, SEEK_SET) != 0 ||
+        fwrite(&hdr, sizeof(hdr), 1, w->f) != 1 ||
+        fclose(w->f) != 0) {
+        fprintf(stderr, "trace: write failed\n");
+        rc = 1;
+    }
+    free(w->file_handle);
+    free(w->strings);
+    memset(w, 0, sizeof(*w));
+    return rc;
+}
+
+/* -------------------------------------------------------------------------
+ * JSON conversion
+ * ---------------------------------------------------------------------- */
+
+static void convert_command(const ScenarioCommand *cmd, void *user) {
+    TraceWriter *w = user;
+    if (strcmp(cmd->type, "addVehicle") == 0) {
+        trace_writer_add_vehicle(w, road_from_name(cmd->start_road),
+                                 road_from_name(cmd->end_road),
+                                 cmd->vehicle_id);
+    } else if (strcmp(cmd->type, "step") == 0) {
+        trace_writer_step(w, 1);
+    }
+}
+
+int trace_convert_json(const char *json_path, const char *trace_path) {
+    TraceWriter w;
+    if (trace_writer_open(&w, trace_path) != 0) {
+        return 1;
+    }
+    int rc = json_for_each_command(json_path, convert_command, &w);
+    if (trace_writer_close(&w) != 0) {
+        rc = 1;
+    }
+    return rc;
+}
@@ -3,6 +3,7 @@
 void traffic_light_init(TrafficLight *tl) {
     tl->state           = LIGHT_RED;
     tl->steps_remaining = 0;
+    tl->yellow_steps    = YELLOW_STEPS;
 }
 
 void traffic_light_set_green(TrafficLight *tl, uint8_t duration) {
@@ -29,7 +30,7 @@ void traffic_light_tick(TrafficLight *tl) {
             case LIGHT_GREEN:
             case LIGHT_GREEN_ARROW:
                 tl->state           = LIGHT_YELLOW;
-                tl->steps_remaining = YELLOW_STEPS;
+                tl->steps_remaining = tl->yellow_steps;
                 break;
             case LIGHT_YELLOW:
                 tl->state           = LIGHT_RED;
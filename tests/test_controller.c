@@ -1,6 +1,8 @@
 #include <string.h>
 #include <stdio.h>
 #include "controller.h"
+#include "intern.h"
+#include "intersection.h"
 #include "road.h"
 #include "test_helpers.h"
 
@@ -14,6 +16,11 @@ static Intersection make_empty_intersection(void) {
     for (int i = 0; i < ROAD_COUNT; i++) {
         road_init(&inter.roads[i]);
     }
+    inter.params = (ControllerParams){
+        .min_green_steps = MIN_GREEN_STEPS,
+        .max_green_steps = MAX_GREEN_STEPS,
+        .yellow_steps    = YELLOW_STEPS,
+    };
     inter.current_phase = PHASE_NS;
     inter.step_count    = 0;
     return inter;
@@ -23,11 +30,15 @@ static void add_vehicle(Intersection *inter, RoadDir start, RoadDir end,
                         const char *id) {
     Vehicle v;
     memset(&v, 0, sizeof(v));
-    strncpy(v.id, id, MAX_VEHICLE_ID_LEN - 1);
+    v.id           = vehicle_id_intern(id);
     v.end_road     = end;
     v.movement     = movement_type(start, end);
     v.enqueue_step = inter->step_count;
     road_enqueue(&inter->roads[start], &v);
+
+    /* Tests build state behind the intersection's back, so refresh the
+     * cached scores controller_next_phase() reads. */
+    intersection_rebuild_scores(inter);
 }
 
 /*
@@ -185,6 +196,33 @@ static void test_duration_clamped_to_max(void) {
     ASSERT_EQ(d.duration, MAX_GREEN_STEPS);
 }
 
+static void test_duration_uses_runtime_params(void) {
+    Intersection inter = make_empty_intersection();
+    ControllerParams params = {
+        .min_green_steps = 5,
+        .max_green_steps = 6,
+        .yellow_steps    = 3,
+    };
+    intersection_set_params(&inter, &params);
+
+    /* One vehicle: clamped up to the custom minimum, not MIN_GREEN_STEPS. */
+    add_vehicle(&inter, ROAD_NORTH, ROAD_SOUTH, "v1");
+    PhaseDecision d = controller_next_phase(&inter);
+    ASSERT_EQ(d.duration, 5u);
+
+    /* Overfill: clamped down to the custom maximum. */
+    for (int i = 0; i < 10; i++) {
+        char id[8];
+        snprintf(id, sizeof(id), "m%d", i);
+        add_vehicle(&inter, ROAD_NORTH, ROAD_SOUTH, id);
+    }
+    d = controller_next_phase(&inter);
+    ASSERT_EQ(d.duration, 6u);
+
+    /* Custom yellow duration reaches the lights. */
+    ASSERT_EQ(inter.lights[ROAD_NORTH].yellow_steps, 3u);
+}
+
 /*
  * Starvation prevention: wait time shifts selection
  */
@@ -226,6 +264,7 @@ int main(void) {
     RUN_TEST(test_duration_clamped_to_min);
     RUN_TEST(test_duration_proportional_to_queue);
     RUN_TEST(test_duration_clamped_to_max);
+    RUN_TEST(test_duration_uses_runtime_params);
     RUN_TEST(test_starvation_prevention);
     PRINT_RESULTS();
 }
@@ -0,0 +1,184 @@
+#include <string.h>
+#include <stdio.h>
+#include "grid.h"
+#include "intern.h"
+#include "intersection.h"
+#include "road.h"
+#include "test_helpers.h"
+
+/*
+ * Grid engine tests. The interesting property is equivalence: a grid
+ * cell must behave exactly like a standalone Intersection, serial and
+ * parallel stepping must agree, and workers must never corrupt each
+ * other's cells.
+ */
+
+static void test_create_dimensions(void) {
+    Grid *g = grid_create(3, 2, 0);
+    ASSERT(g != NULL);
+    ASSERT_EQ(grid_width(g), 3);
+    ASSERT_EQ(grid_height(g), 2);
+    grid_destroy(g);
+}
+
+static void test_create_rejects_empty(void) {
+    ASSERT(grid_create(0, 4, 0) == NULL);
+    ASSERT(grid_create(4, 0, 0) == NULL);
+}
+
+static void test_1x1_matches_single_intersection(void) {
+    Grid *g = grid_create(1, 1, 0);
+    Intersection ref;
+    intersection_init(&ref);
+
+    intersection_add_vehicle(grid_at(g, 0, 0), ROAD_NORTH, ROAD_SOUTH, "v1");
+    intersection_add_vehicle(&ref,             ROAD_NORTH, ROAD_SOUTH, "v1");
+
+    for (int i = 0; i < 5; i++) {
+        grid_step(g);
+        Vehicle dep[MAX_DEPARTURES_PER_STEP];
+        uint8_t count;
+        intersection_step(&ref, dep, &count);
+
+        ASSERT_EQ(grid_departed_count(g, 0, 0), count);
+        ASSERT_EQ(grid_at(g, 0, 0)->step_count, ref.step_count);
+        ASSERT_EQ(grid_at(g, 0, 0)->current_phase, ref.current_phase);
+    }
+    grid_destroy(g);
+}
+
+static void test_step_advances_all_cells(void) {
+    Grid *g = grid_create(4, 4, 0);
+    for (int i = 0; i < 3; i++) {
+        grid_step(g);
+    }
+    for (uint16_t y = 0; y < 4; y++) {
+        for (uint16_t x = 0; x < 4; x++) {
+            ASSERT_EQ(grid_at(g, x, y)->step_count, 3u);
+        }
+    }
+    grid_destroy(g);
+}
+
+static void test_parallel_matches_serial(void) {
+    /* Same traffic into a serial and a 4-worker grid; every cell must
+     * end up in an identical state. */
+    Grid *serial   = grid_create(8, 8, 0);
+    Grid *parallel = grid_create(8, 8, 4);
+
+    for (uint16_t y = 0; y < 8; y++) {
+        for (uint16_t x = 0; x < 8; x++) {
+            char id[16];
+            snprintf(id, sizeof(id), "v%u_%u", x, y);
+            RoadDir start = (RoadDir)((x + y) % ROAD_COUNT);
+            RoadDir end   = (RoadDir)((x + y + 2) % ROAD_COUNT);
+            intersection_add_vehicle(grid_at(serial, x, y), start, end, id);
+            intersection_add_vehicle(grid_at(parallel, x, y), start, end, id);
+        }
+    }
+
+    for (int i = 0; i < 10; i++) {
+        grid_step(serial);
+        grid_step(parallel);
+    }
+
+    for (uint16_t y = 0; y < 8; y++) {
+        for (uint16_t x = 0; x < 8; x++) {
+            Intersection *a = grid_at(serial, x, y);
+            Intersection *b = grid_at(parallel, x, y);
+            ASSERT_EQ(a->step_count, b->step_count);
+            ASSERT_EQ(a->current_phase, b->current_phase);
+            ASSERT_EQ(intersection_total_waiting(a),
+                      intersection_total_waiting(b));
+        }
+    }
+
+    grid_destroy(serial);
+    grid_destroy(parallel);
+}
+
+static void test_worker_clamping(void) {
+    /* More workers than cells must not crash or deadlock. */
+    Grid *g = grid_create(2, 1, 64);
+    grid_step(g);
+    ASSERT_EQ(grid_at(g, 0, 0)->step_count, 1u);
+    ASSERT_EQ(grid_at(g, 1, 0)->step_count, 1u);
+    grid_destroy(g);
+}
+
+/*
+ * Handoff: a vehicle heading east out of cell (0,0) must be handed off
+ * onto the west road of cell (1,0), depart it still heading east, and
+ * then cross the grid boundary and exit the system. (It may arrive and
+ * depart (1,0) in the same step if the phase lines up, so we watch the
+ * departure record rather than the queue.)
+ */
+static void test_handoff_corridor(void) {
+    Grid *g = grid_create(2, 1, 0);
+    ASSERT_EQ(grid_enable_handoff(g, 1), 0);
+
+    intersection_add_vehicle(grid_at(g, 0, 0), ROAD_WEST, ROAD_EAST, "c1");
+
+    bool crossed = false;
+    for (int i = 0; i < 20 && !crossed; i++) {
+        grid_step(g);
+        if (grid_departed_count(g, 1, 0) > 0) {
+            const Vehicle *v = grid_departed(g, 1, 0);
+            ASSERT_STR_EQ(vehicle_id_str(v[0].id), "c1");
+            ASSERT_EQ(v[0].end_road, ROAD_EAST);
+            crossed = true;
+        }
+    }
+    ASSERT(crossed);
+    ASSERT_EQ(grid_exited_count(g), 1u);
+    ASSERT_EQ(grid_dropped_count(g), 0u);
+    grid_destroy(g);
+}
+
+static void test_handoff_parallel_matches_serial(void) {
+    Grid *serial   = grid_create(6, 6, 0);
+    Grid *parallel = grid_create(6, 6, 4);
+    grid_enable_handoff(serial, 2);
+    grid_enable_handoff(parallel, 2);
+
+    for (uint16_t y = 0; y < 6; y++) {
+        for (uint16_t x = 0; x < 6; x++) {
+            char id[16];
+            snprintf(id, sizeof(id), "h%u_%u", x, y);
+            RoadDir start = (RoadDir)((x + 2 * y) % ROAD_COUNT);
+            RoadDir end   = (RoadDir)((x + 2 * y + 1) % ROAD_COUNT);
+            intersection_add_vehicle(grid_at(serial, x, y), start, end, id);
+            intersection_add_vehicle(grid_at(parallel, x, y), start, end, id);
+        }
+    }
+
+    for (int i = 0; i < 40; i++) {
+        grid_step(serial);
+        grid_step(parallel);
+    }
+
+    ASSERT_EQ(grid_exited_count(serial), grid_exited_count(parallel));
+    for (uint16_t y = 0; y < 6; y++) {
+        for (uint16_t x = 0; x < 6; x++) {
+            ASSERT_EQ(intersection_total_waiting(grid_at(serial, x, y)),
+                      intersection_total_waiting(grid_at(parallel, x, y)));
+            ASSERT_EQ(grid_at(serial, x, y)->current_phase,
+                      grid_at(parallel, x, y)->current_phase);
+        }
+    }
+
+    grid_destroy(serial);
+    grid_destroy(parallel);
+}
+
+int main(void) {
+    RUN_TEST(test_create_dimensions);
+    RUN_TEST(test_create_rejects_empty);
+    RUN_TEST(test_1x1_matches_single_intersection);
+    RUN_TEST(test_step_advances_all_cells);
+    RUN_TEST(test_parallel_matches_serial);
+    RUN_TEST(test_worker_clamping);
+    RUN_TEST(test_handoff_corridor);
+    RUN_TEST(test_handoff_parallel_matches_serial);
+    PRINT_RESULTS();
+}
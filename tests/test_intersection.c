@@ -1,5 +1,7 @@
 #include <string.h>
 #include <stdio.h>
+#include "controller.h"
+#include "intern.h"
 #include "intersection.h"
 #include "road.h"
 #include "test_helpers.h"
@@ -12,7 +14,7 @@
 static bool departed_contains(const Vehicle *departed, uint8_t count,
                                const char *id) {
     for (uint8_t i = 0; i < count; i++) {
-        if (strcmp(departed[i].id, id) == 0) return true;
+        if (strcmp(vehicle_id_str(departed[i].id), id) == 0) return true;
     }
     return false;
 }
@@ -223,6 +225,222 @@ static void test_multiple_lanes_depart_in_same_step(void) {
     ASSERT(departed_contains(dep, dep_count, "right"));
 }
 
+typedef struct {
+    uint8_t count;
+    RoadDir roads[MAX_DEPARTURES_PER_STEP];
+    Lane    lanes[MAX_DEPARTURES_PER_STEP];
+    uint32_t ids[MAX_DEPARTURES_PER_STEP];
+} CbLog;
+
+static void log_departure(void *user, RoadDir road, Lane lane,
+                          const Vehicle *v) {
+    CbLog *log = user;
+    log->roads[log->count] = road;
+    log->lanes[log->count] = lane;
+    log->ids[log->count]   = v->id;
+    log->count++;
+}
+
+static void test_step_cb_reports_departures(void) {
+    Intersection inter;
+    intersection_init(&inter);
+
+    intersection_add_vehicle(&inter, ROAD_NORTH, ROAD_SOUTH, "cb-straight");
+    intersection_add_vehicle(&inter, ROAD_NORTH, ROAD_WEST,  "cb-right");
+
+    CbLog log = { 0 };
+    intersection_step_cb(&inter, log_departure, &log);
+
+    ASSERT_EQ(log.count, 2);
+    bool saw_straight = false, saw_right = false;
+    for (uint8_t i = 0; i < log.count; i++) {
+        ASSERT_EQ(log.roads[i], ROAD_NORTH);
+        if (log.lanes[i] == LANE_STRAIGHT) {
+            ASSERT(strcmp(vehicle_id_str(log.ids[i]), "cb-straight") == 0);
+            saw_straight = true;
+        }
+        if (log.lanes[i] == LANE_RIGHT) {
+            ASSERT(strcmp(vehicle_id_str(log.ids[i]), "cb-right") == 0);
+            saw_right = true;
+        }
+    }
+    ASSERT(saw_straight && saw_right);
+}
+
+static void test_wait_histogram_records_departures(void) {
+    Intersection inter;
+    intersection_init(&inter);
+
+    /* Served on the very first step: a zero-step wait in bucket 0. */
+    intersection_add_vehicle(&inter, ROAD_NORTH, ROAD_SOUTH, "w1");
+    step(&inter);
+
+    ASSERT_EQ(inter.wait_hists[ROAD_NORTH].count, 1);
+    ASSERT_EQ(inter.wait_hists[ROAD_NORTH].total, 0);
+    ASSERT_EQ(inter.wait_hists[ROAD_NORTH].buckets[0], 1);
+    ASSERT_EQ(inter.wait_hists[ROAD_EAST].count, 0);
+
+    /* An East vehicle has to wait out the active NS phase. */
+    intersection_add_vehicle(&inter, ROAD_EAST, ROAD_WEST, "w2");
+    uint32_t enqueued_at = inter.step_count;
+    while (inter.wait_hists[ROAD_EAST].count == 0) {
+        ASSERT(inter.step_count < enqueued_at + 100);
+        step(&inter);
+    }
+    ASSERT_EQ(inter.wait_hists[ROAD_EAST].count, 1);
+    ASSERT(inter.wait_hists[ROAD_EAST].max >= 1);
+    ASSERT_EQ(inter.wait_hists[ROAD_EAST].total,
+              inter.wait_hists[ROAD_EAST].max);
+}
+
+static void test_wait_histogram_percentiles(void) {
+    WaitHist h;
+    memset(&h, 0, sizeof(h));
+    ASSERT_EQ(waithist_percentile(&h, 0.99), 0);
+
+    /* 90 instant departures and 10 waits of 100 steps: the median sits
+     * in bucket 0, the p99 in the bucket covering waits < 128. */
+    for (int i = 0; i < 90; i++) {
+        waithist_record(&h, 0);
+    }
+    for (int i = 0; i < 10; i++) {
+        waithist_record(&h, 100);
+    }
+    ASSERT_EQ(h.count, 100);
+    ASSERT_EQ(h.total, 1000);
+    ASSERT_EQ(h.max, 100);
+    ASSERT_EQ(waithist_percentile(&h, 0.50), 0);
+    ASSERT_EQ(waithist_percentile(&h, 0.99), 127);
+}
+
+/*
+ * Cached score coherence: after any mix of adds and steps, the scores
+ * maintained incrementally must match controller_phase_score() computed
+ * from scratch.
+ */
+static void test_cached_scores_match_reference(void) {
+    Intersection inter;
+    intersection_init(&inter);
+
+    intersection_add_vehicle(&inter, ROAD_NORTH, ROAD_SOUTH, "n1");
+    intersection_add_vehicle(&inter, ROAD_EAST,  ROAD_WEST,  "e1");
+    intersection_add_vehicle(&inter, ROAD_EAST,  ROAD_SOUTH, "e2"); /* left */
+
+    for (int i = 0; i < 10; i++) {
+        step(&inter);
+        if (i == 3) {
+            intersection_add_vehicle(&inter, ROAD_WEST, ROAD_EAST, "w1");
+        }
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            ASSERT_EQ(inter.phase_scores[p],
+                      controller_phase_score(&inter, (Phase)p));
+        }
+    }
+}
+
+/* Snapshot round-trip: save mid-scenario, diverge, restore, re-run. */
+static void test_snapshot_restore_roundtrip(void) {
+    Intersection inter;
+    intersection_init(&inter);
+
+    intersection_add_vehicle(&inter, ROAD_NORTH, ROAD_SOUTH, "v1");
+    intersection_add_vehicle(&inter, ROAD_EAST,  ROAD_WEST,  "v2");
+    step(&inter);
+
+    static uint8_t blob[16384];
+    size_t size = intersection_save(&inter, blob, sizeof(blob));
+    ASSERT(size > 0);
+    ASSERT_EQ(size, intersection_snapshot_size(&inter));
+
+    /* Diverge: run the original forward a few steps. */
+    for (int i = 0; i < 4; i++) {
+        step(&inter);
+    }
+    uint32_t diverged_step = inter.step_count;
+
+    /* Restore into a differently initialised intersection. */
+    Intersection copy;
+    intersection_init(&copy);
+    intersection_add_vehicle(&copy, ROAD_SOUTH, ROAD_WEST, "noise");
+    ASSERT(intersection_load(&copy, blob, size));
+
+    ASSERT_EQ(copy.step_count, 1u);
+    ASSERT(copy.step_count != diverged_step);
+    ASSERT_EQ(intersection_total_waiting(&copy), 1);
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        ASSERT_EQ(copy.phase_scores[p],
+                  controller_phase_score(&copy, (Phase)p));
+    }
+
+    /* The queued vehicle keeps its identity through the blob. */
+    Vehicle out;
+    ASSERT(road_peek_lane(&copy.roads[ROAD_EAST], LANE_STRAIGHT, &out));
+    ASSERT_STR_EQ(vehicle_id_str(out.id), "v2");
+}
+
+/* Fast-forwarding an empty intersection must land on exactly the state
+ * that stepping one at a time would reach - including mid-yellow start
+ * states left over from the last served vehicle. */
+static void test_fast_forward_matches_stepping(void) {
+    Intersection looped, skipped;
+    intersection_init(&looped);
+    intersection_init(&skipped);
+
+    /* Serve one vehicle first so the lights are mid-cycle, not pristine. */
+    intersection_add_vehicle(&looped,  ROAD_NORTH, ROAD_SOUTH, "ff1");
+    intersection_add_vehicle(&skipped, ROAD_NORTH, ROAD_SOUTH, "ff1");
+    step(&looped);
+    intersection_step(&skipped, dep, &dep_count);
+
+    enum { FF_STEPS = 1000 };
+    for (int i = 0; i < FF_STEPS; i++) {
+        step(&looped);
+    }
+    ASSERT_EQ(intersection_fast_forward(&skipped, FF_STEPS), FF_STEPS);
+
+    ASSERT_EQ(skipped.step_count, looped.step_count);
+    ASSERT_EQ(skipped.current_phase, looped.current_phase);
+    ASSERT_EQ(skipped.phase_steps_remaining, looped.phase_steps_remaining);
+    ASSERT_EQ(skipped.in_yellow_transition, looped.in_yellow_transition);
+    for (int r = 0; r < ROAD_COUNT; r++) {
+        ASSERT_EQ(skipped.lights[r].state, looped.lights[r].state);
+        ASSERT_EQ(skipped.lights[r].steps_remaining,
+                  looped.lights[r].steps_remaining);
+    }
+
+    /* Both must respond identically to traffic arriving afterwards. */
+    intersection_add_vehicle(&looped,  ROAD_EAST, ROAD_WEST, "ff2");
+    intersection_add_vehicle(&skipped, ROAD_EAST, ROAD_WEST, "ff2");
+    for (int i = 0; i < 2 * MAX_GREEN_STEPS; i++) {
+        step(&looped);
+        bool left = departed_contains(dep, dep_count, "ff2");
+        intersection_step(&skipped, dep, &dep_count);
+        ASSERT_EQ(departed_contains(dep, dep_count, "ff2"), left);
+    }
+    ASSERT_EQ(intersection_total_waiting(&looped), 0);
+    ASSERT_EQ(intersection_total_waiting(&skipped), 0);
+}
+
+/* A non-empty intersection must refuse to fast-forward. */
+static void test_fast_forward_requires_empty(void) {
+    Intersection inter;
+    intersection_init(&inter);
+    intersection_add_vehicle(&inter, ROAD_NORTH, ROAD_SOUTH, "busy");
+    ASSERT_EQ(intersection_fast_forward(&inter, 100), 0);
+    ASSERT_EQ(inter.step_count, 0);
+}
+
+/* A corrupted blob must be rejected and leave the target untouched. */
+static void test_snapshot_load_rejects_garbage(void) {
+    Intersection inter;
+    intersection_init(&inter);
+    intersection_add_vehicle(&inter, ROAD_NORTH, ROAD_SOUTH, "v1");
+
+    uint8_t blob[64];
+    memset(blob, 0xAB, sizeof(blob));
+    ASSERT(!intersection_load(&inter, blob, sizeof(blob)));
+    ASSERT_EQ(intersection_total_waiting(&inter), 1);
+}
 
 int main(void) {
     RUN_TEST(test_init_empty);
@@ -237,5 +455,13 @@ int main(void) {
     RUN_TEST(test_step_count_increments);
     RUN_TEST(test_vehicle_count_decreases_after_departure);
     RUN_TEST(test_multiple_lanes_depart_in_same_step);
+    RUN_TEST(test_step_cb_reports_departures);
+    RUN_TEST(test_wait_histogram_records_departures);
+    RUN_TEST(test_wait_histogram_percentiles);
+    RUN_TEST(test_cached_scores_match_reference);
+    RUN_TEST(test_fast_forward_matches_stepping);
+    RUN_TEST(test_fast_forward_requires_empty);
+    RUN_TEST(test_snapshot_restore_roundtrip);
+    RUN_TEST(test_snapshot_load_rejects_garbage);
     PRINT_RESULTS();
 }
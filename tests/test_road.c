@@ -1,5 +1,6 @@
 #include <string.h>
 #include <stdio.h>
+#include "intern.h"
 #include "road.h"
 #include "test_helpers.h"
 
@@ -63,7 +64,7 @@ static void test_lane_for_movement(void) {
 static Vehicle make_vehicle(const char *id, RoadDir end, MovementType mv) {
     Vehicle v;
     memset(&v, 0, sizeof(v));
-    strncpy(v.id, id, MAX_VEHICLE_ID_LEN - 1);
+    v.id           = vehicle_id_intern(id);
     v.end_road     = end;
     v.movement     = mv;
     v.enqueue_step = 0;
@@ -92,9 +93,9 @@ static void test_queue_enqueue_dequeue(void) {
     Vehicle out;
     /* FIFO order */
     ASSERT(queue_dequeue(&q, &out));
-    ASSERT_STR_EQ(out.id, "v1");
+    ASSERT_STR_EQ(vehicle_id_str(out.id), "v1");
     ASSERT(queue_dequeue(&q, &out));
-    ASSERT_STR_EQ(out.id, "v2");
+    ASSERT_STR_EQ(vehicle_id_str(out.id), "v2");
     ASSERT(queue_is_empty(&q));
 }
 
@@ -107,7 +108,7 @@ static void test_queue_peek_does_not_remove(void) {
 
     Vehicle out;
     ASSERT(queue_peek(&q, &out));
-    ASSERT_STR_EQ(out.id, "v1");
+    ASSERT_STR_EQ(vehicle_id_str(out.id), "v1");
     ASSERT_EQ(q.count, 1); /* still in queue */
 }
 
@@ -149,6 +150,73 @@ static void test_queue_wraps_around(void) {
     ASSERT(queue_is_full(&q));
 }
 
+static void test_queue_total_wait(void) {
+    VehicleQueue q;
+    queue_init(&q);
+    ASSERT_EQ(queue_total_wait(&q, 100), 0u);
+
+    /* Arrivals at steps 2, 5 and 9; at step 10 they have waited
+     * 8 + 5 + 1 = 14 steps between them. */
+    Vehicle v = make_vehicle("w1", ROAD_SOUTH, MOVE_STRAIGHT);
+    v.enqueue_step = 2;
+    queue_enqueue(&q, &v);
+    v.enqueue_step = 5;
+    queue_enqueue(&q, &v);
+    v.enqueue_step = 9;
+    queue_enqueue(&q, &v);
+    ASSERT_EQ(queue_total_wait(&q, 10), 14u);
+
+    /* Dequeue drops the front vehicle's contribution. */
+    queue_dequeue(&q, NULL);
+    ASSERT_EQ(queue_total_wait(&q, 10), 6u);
+
+    /* The sum survives wrap-around of the ring indices: the two
+     * remaining vehicles are step-10 arrivals afterwards. */
+    for (int i = 0; i < MAX_VEHICLES_PER_LANE; i++) {
+        v.enqueue_step = 10;
+        queue_enqueue(&q, &v);
+        queue_dequeue(&q, NULL);
+    }
+    ASSERT_EQ(queue_total_wait(&q, 12), 4u);
+}
+
+#if TSIM_SPILL_POOL
+static void test_queue_spills_past_ring_capacity(void) {
+    static SpillPool pool;
+    spill_pool_init(&pool);
+
+    VehicleQueue q;
+    queue_init(&q);
+    queue_attach_spill(&q, &pool);
+
+    /* Fill past the inline ring; the overflow lands in the pool. */
+    char id[16];
+    for (int i = 0; i < MAX_VEHICLES_PER_LANE + 10; i++) {
+        snprintf(id, sizeof(id), "s%d", i);
+        Vehicle v = make_vehicle(id, ROAD_SOUTH, MOVE_STRAIGHT);
+        ASSERT(queue_enqueue(&q, &v));
+    }
+
+    /* FIFO order holds across the ring/spill boundary. */
+    for (int i = 0; i < MAX_VEHICLES_PER_LANE + 10; i++) {
+        Vehicle out;
+        ASSERT(queue_dequeue(&q, &out));
+        snprintf(id, sizeof(id), "s%d", i);
+        ASSERT_STR_EQ(vehicle_id_str(out.id), id);
+    }
+    ASSERT(queue_is_empty(&q));
+
+    /* Every node went back to the free list: the lane can grow to ring
+     * plus full pool again, and only then reject. */
+    Vehicle v = make_vehicle("cap", ROAD_SOUTH, MOVE_STRAIGHT);
+    for (int i = 0; i < MAX_VEHICLES_PER_LANE + SPILL_POOL_SIZE; i++) {
+        ASSERT(queue_enqueue(&q, &v));
+    }
+    ASSERT(queue_is_full(&q));
+    ASSERT(!queue_enqueue(&q, &v));
+}
+#endif
+
 /* Road operations */
 static void test_road_init(void) {
     Road r;
@@ -190,7 +258,7 @@ static void test_road_dequeue_lane(void) {
 
     Vehicle out;
     ASSERT(road_dequeue_lane(&r, LANE_STRAIGHT, &out));
-    ASSERT_STR_EQ(out.id, "s1");
+    ASSERT_STR_EQ(vehicle_id_str(out.id), "s1");
     ASSERT_EQ(road_lane_count(&r, LANE_STRAIGHT), 0);
 
     /* Dequeue from empty lane returns false */
@@ -206,7 +274,7 @@ static void test_road_peek_lane(void) {
 
     Vehicle out;
     ASSERT(road_peek_lane(&r, LANE_RIGHT, &out));
-    ASSERT_STR_EQ(out.id, "r1");
+    ASSERT_STR_EQ(vehicle_id_str(out.id), "r1");
     ASSERT_EQ(road_lane_count(&r, LANE_RIGHT), 1); /* still there */
 }
 
@@ -224,6 +292,10 @@ int main(void) {
     RUN_TEST(test_queue_dequeue_empty_returns_false);
     RUN_TEST(test_queue_enqueue_full_returns_false);
     RUN_TEST(test_queue_wraps_around);
+    RUN_TEST(test_queue_total_wait);
+#if TSIM_SPILL_POOL
+    RUN_TEST(test_queue_spills_past_ring_capacity);
+#endif
 
     RUN_TEST(test_road_init);
     RUN_TEST(test_road_enqueue_routes_to_correct_lane);
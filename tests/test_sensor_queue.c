@@ -0,0 +1,119 @@
+#include <string.h>
+#include "sensor_queue.h"
+#include "road.h"
+#include "simulation.h"
+#include "intersection.h"
+#include "test_helpers.h"
+
+static void test_pop_empty_queue(void) {
+    SensorQueue q;
+    sensor_queue_init(&q);
+    SensorEvent e;
+    ASSERT(!sensor_queue_pop(&q, &e));
+}
+
+static void test_push_pop_fifo(void) {
+    SensorQueue q;
+    sensor_queue_init(&q);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        SensorEvent e = { .road = (uint8_t)i, .lane = 1, .timestamp = 100 + i };
+        ASSERT(sensor_queue_push(&q, &e));
+    }
+    for (uint32_t i = 0; i < 3; i++) {
+        SensorEvent e;
+        ASSERT(sensor_queue_pop(&q, &e));
+        ASSERT_EQ(e.road, i);
+        ASSERT_EQ(e.lane, 1u);
+        ASSERT_EQ(e.timestamp, 100 + i);
+    }
+    SensorEvent e;
+    ASSERT(!sensor_queue_pop(&q, &e));
+}
+
+static void test_push_rejects_when_full(void) {
+    SensorQueue q;
+    sensor_queue_init(&q);
+    SensorEvent e = { .road = 0, .lane = 0, .timestamp = 0 };
+
+    for (uint32_t i = 0; i < SENSOR_QUEUE_SIZE - 1u; i++) {
+        ASSERT(sensor_queue_push(&q, &e));
+    }
+    ASSERT(!sensor_queue_push(&q, &e));
+
+    /* Popping one frees exactly one slot. */
+    SensorEvent out;
+    ASSERT(sensor_queue_pop(&q, &out));
+    ASSERT(sensor_queue_push(&q, &e));
+    ASSERT(!sensor_queue_push(&q, &e));
+}
+
+static void test_indices_wrap_around(void) {
+    SensorQueue q;
+    sensor_queue_init(&q);
+
+    for (uint32_t i = 0; i < 4 * SENSOR_QUEUE_SIZE; i++) {
+        SensorEvent e = { .road = 2, .lane = 0, .timestamp = i };
+        ASSERT(sensor_queue_push(&q, &e));
+        SensorEvent out;
+        ASSERT(sensor_queue_pop(&q, &out));
+        ASSERT_EQ(out.timestamp, i);
+    }
+}
+
+/* ---- simulation_tick() integration (stub HAL) ------------------------ */
+
+static bool stub_sense[ROAD_COUNT][LANES_PER_ROAD];
+
+static bool stub_sense_lane(RoadDir road, Lane lane) {
+    return stub_sense[road][lane];
+}
+
+static void stub_set_light(RoadDir road, LightState state) {
+    (void)road;
+    (void)state;
+}
+
+static const EmbeddedHAL STUB_HAL = { stub_sense_lane, stub_set_light, NULL };
+
+static void test_tick_drains_isr_events(void) {
+    SimulationContext ctx;
+    simulation_init(&ctx);
+    memset(stub_sense, 0, sizeof(stub_sense));
+
+    /* Two edges caught by interrupts, sensors already clear again. */
+    ASSERT(simulation_sensor_isr(&ctx, ROAD_NORTH, LANE_STRAIGHT, 10));
+    ASSERT(simulation_sensor_isr(&ctx, ROAD_EAST, LANE_LEFT, 11));
+
+    simulation_tick(&ctx, &STUB_HAL);
+    ASSERT_EQ(road_lane_count(&ctx.inter.roads[ROAD_EAST], LANE_LEFT), 1u);
+    ASSERT_EQ(ctx.vehicle_counter, 2u);
+}
+
+static void test_isr_event_not_double_counted_by_poll(void) {
+    SimulationContext ctx;
+    simulation_init(&ctx);
+    memset(stub_sense, 0, sizeof(stub_sense));
+
+    /* The interrupt fired and the sensor is still occupied at the next
+     * poll - that is one vehicle, not two. */
+    ASSERT(simulation_sensor_isr(&ctx, ROAD_SOUTH, LANE_RIGHT, 42));
+    stub_sense[ROAD_SOUTH][LANE_RIGHT] = true;
+
+    simulation_tick(&ctx, &STUB_HAL);
+    ASSERT_EQ(ctx.vehicle_counter, 1u);
+
+    /* And it stays one vehicle while the sensor remains occupied. */
+    simulation_tick(&ctx, &STUB_HAL);
+    ASSERT_EQ(ctx.vehicle_counter, 1u);
+}
+
+int main(void) {
+    RUN_TEST(test_pop_empty_queue);
+    RUN_TEST(test_push_pop_fifo);
+    RUN_TEST(test_push_rejects_when_full);
+    RUN_TEST(test_indices_wrap_around);
+    RUN_TEST(test_tick_drains_isr_events);
+    RUN_TEST(test_isr_event_not_double_counted_by_poll);
+    PRINT_RESULTS();
+}
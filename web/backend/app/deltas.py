@@ -0,0 +1,79 @@
+"""Binary delta encoding for WebSocket streaming.
+
+Polling /api/state costs a full HTTP round-trip plus a JSON encode of the
+whole intersection for every animation frame, even when only one light
+changed.  The /ws endpoint instead pushes one compact binary frame per
+simulation step containing only what changed since the previous frame.
+
+Frame layout (all integers little-endian):
+
+    u32  step_count
+    u8   phase byte: bits 0-2 current_phase, bit 7 in_yellow_transition
+    u8   light mask: bit r set if road r's light state changed
+    u16  lane mask: bit (road * 3 + lane) set if that queue length changed
+    u8   departure count
+    u8 x popcount(light mask)   new light states, in road order
+    u8 x popcount(lane mask)    new queue lengths, in lane-index order
+    per departure: u8 id length, then that many UTF-8 id bytes
+
+A typical frame (one light change, two lane counts, one departure) is
+under 20 bytes.  Clients bootstrap by fetching /api/state once, then apply
+deltas; a frame encoded against ``prev=None`` (the first step after a
+connect or reset) has every mask bit set and doubles as a full sync.
+"""
+
+from __future__ import annotations
+
+import struct
+
+from .models import IntersectionState
+
+LANE_NAMES = ("left", "straight", "right")
+
+
+def encode_delta(
+    prev: IntersectionState | None,
+    cur: IntersectionState,
+    departed: list[str],
+) -> bytes:
+    """Encode the change from ``prev`` to ``cur`` as one binary frame."""
+    light_mask = 0
+    light_states: list[int] = []
+    lane_mask = 0
+    lane_counts: list[int] = []
+
+    for road in cur.roads:
+        r = int(road.direction)
+        prev_road = prev.roads[r] if prev is not None else None
+
+        if prev_road is None or prev_road.light.state != road.light.state:
+            light_mask |= 1 << r
+            light_states.append(int(road.light.state))
+
+        for lane_idx, name in enumerate(LANE_NAMES):
+            count = road.lanes[name].queue_length
+            if prev_road is None or prev_road.lanes[name].queue_length != count:
+                lane_mask |= 1 << (r * 3 + lane_idx)
+                lane_counts.append(min(count, 255))
+
+    phase_byte = int(cur.current_phase) & 0x07
+    if cur.in_yellow_transition:
+        phase_byte |= 0x80
+
+    frame = bytearray(
+        struct.pack(
+            "<IBBHB",
+            cur.step_count,
+            phase_byte,
+            light_mask,
+            lane_mask,
+            min(len(departed), 255),
+        )
+    )
+    frame.extend(light_states)
+    frame.extend(lane_counts)
+    for vehicle_id in departed[:255]:
+        raw = vehicle_id.encode()[:255]
+        frame.append(len(raw))
+        frame.extend(raw)
+    return bytes(frame)
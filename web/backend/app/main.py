@@ -6,7 +6,7 @@ import os
 from contextlib import asynccontextmanager
 from pathlib import Path
 
-from fastapi import FastAPI, HTTPException
+from fastapi import FastAPI, HTTPException, WebSocket, WebSocketDisconnect
 from fastapi.middleware.cors import CORSMiddleware
 from fastapi.responses import FileResponse
 from fastapi.staticfiles import StaticFiles
@@ -42,6 +42,55 @@ app.add_middleware(
     allow_headers=["*"],
 )
 
+# ---------------------------------------------------------------------------
+# WebSocket streaming
+# ---------------------------------------------------------------------------
+
+class DeltaHub:
+    """Fan-out of binary step deltas to every connected WebSocket.
+
+    Broadcast happens inside the /api/step handler, so frames go out in
+    step order with no extra task or queue.  A client that errors mid-send
+    (closed tab, dead proxy) is dropped; it can reconnect and resync via
+    /api/state.
+    """
+
+    def __init__(self) -> None:
+        self._clients: set[WebSocket] = set()
+
+    async def connect(self, ws: WebSocket) -> None:
+        await ws.accept()
+        self._clients.add(ws)
+
+    def disconnect(self, ws: WebSocket) -> None:
+        self._clients.discard(ws)
+
+    async def broadcast(self, frame: bytes) -> None:
+        for ws in list(self._clients):
+            try:
+                await ws.send_bytes(frame)
+            except Exception:
+                self._clients.discard(ws)
+
+
+hub = DeltaHub()
+
+
+@app.websocket("/ws")
+async def ws_updates(ws: WebSocket):
+    """Push one binary delta frame per simulation step (see deltas.py).
+
+    Clients fetch /api/state once for a baseline, then apply deltas.
+    Incoming messages are ignored; the socket is push-only.
+    """
+    await hub.connect(ws)
+    try:
+        while True:
+            await ws.receive_text()
+    except WebSocketDisconnect:
+        hub.disconnect(ws)
+
+
 # ---------------------------------------------------------------------------
 # API routes
 # ---------------------------------------------------------------------------
@@ -72,9 +121,11 @@ async def step():
     Returns the list of vehicle IDs that departed during this step.
     """
     try:
-        return simulator.step()
+        response, delta = simulator.step_with_delta()
     except BrokenPipeError:
         raise HTTPException(status_code=503, detail="Simulator process died; call /api/reset")
+    await hub.broadcast(delta)
+    return response
 
 
 @app.post("/api/reset", response_model=ResetResponse)
@@ -67,6 +67,7 @@ class LightInfo(BaseModel):
 
 class LaneInfo(BaseModel):
     queue_length: int
+    vehicles: list[str] = []   # IDs in queue order, front first
 
 
 class RoadInfo(BaseModel):
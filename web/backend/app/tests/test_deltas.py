@@ -0,0 +1,96 @@
+"""Unit tests for the binary delta encoder (no binary required)."""
+
+from __future__ import annotations
+
+import struct
+
+from app.deltas import encode_delta
+from app.models import (
+    IntersectionState,
+    LaneInfo,
+    LightInfo,
+    RoadInfo,
+)
+
+
+def make_state(
+    step_count: int = 0,
+    lights: tuple[int, int, int, int] = (0, 0, 0, 0),
+    counts: dict[tuple[int, str], int] | None = None,
+) -> IntersectionState:
+    counts = counts or {}
+    return IntersectionState(
+        step_count=step_count,
+        current_phase=0,
+        in_yellow_transition=False,
+        roads=[
+            RoadInfo(
+                direction=r,
+                light=LightInfo(state=lights[r], steps_remaining=0),
+                lanes={
+                    name: LaneInfo(queue_length=counts.get((r, name), 0))
+                    for name in ("left", "straight", "right")
+                },
+            )
+            for r in range(4)
+        ],
+    )
+
+
+def parse_header(frame: bytes):
+    return struct.unpack_from("<IBBHB", frame, 0)
+
+
+def test_full_sync_when_prev_is_none():
+    frame = encode_delta(None, make_state(step_count=7), [])
+    step, phase, light_mask, lane_mask, departures = parse_header(frame)
+    assert step == 7
+    assert light_mask == 0b1111          # all four lights reported
+    assert lane_mask == 0b111111111111   # all twelve lanes reported
+    assert departures == 0
+    # header + 4 light states + 12 lane counts
+    assert len(frame) == 9 + 4 + 12
+
+
+def test_no_change_is_header_only():
+    state = make_state(step_count=3)
+    frame = encode_delta(state, make_state(step_count=4), [])
+    _, _, light_mask, lane_mask, departures = parse_header(frame)
+    assert light_mask == 0 and lane_mask == 0 and departures == 0
+    assert len(frame) == 9
+
+
+def test_single_light_and_lane_change():
+    prev = make_state(lights=(0, 0, 0, 0))
+    cur = make_state(
+        step_count=1,
+        lights=(2, 0, 0, 0),                    # north turns green
+        counts={(2, "straight"): 5},            # east straight queue grows
+    )
+    frame = encode_delta(prev, cur, [])
+    _, _, light_mask, lane_mask, _ = parse_header(frame)
+    assert light_mask == 0b0001
+    assert lane_mask == 1 << (2 * 3 + 1)
+    assert frame[9] == 2       # the new light state
+    assert frame[10] == 5      # the new queue length
+    assert len(frame) == 11
+
+
+def test_departures_are_length_prefixed():
+    state = make_state()
+    frame = encode_delta(state, make_state(step_count=1), ["v1", "car42"])
+    _, _, _, _, departures = parse_header(frame)
+    assert departures == 2
+    body = frame[9:]
+    assert body[0] == 2 and body[1:3] == b"v1"
+    assert body[3] == 5 and body[4:9] == b"car42"
+
+
+def test_yellow_flag_and_phase_packing():
+    cur = make_state(step_count=1)
+    cur.current_phase = 3
+    cur.in_yellow_transition = True
+    frame = encode_delta(make_state(), cur, [])
+    _, phase_byte, _, _, _ = parse_header(frame)
+    assert phase_byte & 0x07 == 3
+    assert phase_byte & 0x80